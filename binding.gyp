@@ -42,5 +42,32 @@
                 }]
             ]
         }
+    ],
+    'conditions': [
+        ['OS!="win"', {
+            'targets': [
+                {
+                    'target_name': 'vad-batch',
+                    'type': 'executable',
+                    'include_dirs': ["./src"],
+                    'sources': [
+                        'src/simplevad.c',
+                        'src/vad_batch.cc'
+                    ],
+                    'dependencies': [
+                        './vendor/mpadec/mpadec.gyp:mpadec',
+                        './vendor/webrtc_vad/webrtc_vad.gyp:webrtc_vad'
+                    ],
+                    'conditions': [
+                        ['OS=="mac"', {
+                            "xcode_settings": {
+                                "MACOSX_DEPLOYMENT_TARGET": "10.9",
+                                "CLANG_CXX_LIBRARY": "libc++"
+                            }
+                        }]
+                    ]
+                }
+            ]
+        }]
     ]
 }
@@ -0,0 +1,118 @@
+/**
+ * VAD Library Sample
+ *
+ * The example program measures how voice activity detection scales across worker threads.
+ * All workers analyse the same synthetic signal, which is shared via a SharedArrayBuffer.
+ */
+'use strict'
+
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads'),
+    os = require('os'),
+    VAD = require('vad').vad.VAD
+
+const kSampleRate = 16000,
+    kChunkSamples = kSampleRate / 50 * 4    // 80ms per processAudio call
+
+/**
+ * Fill the given array with alternating segments of noise and voice-like tones
+ * @param {Float32Array} samples Output samples
+ */
+function generateSignal(samples) {
+    let seed = 1
+    const noise = () => {
+        seed = (seed * 1103515245 + 12345) & 0x7fffffff
+        return seed / 0x7fffffff - 0.5
+    }
+
+    for (let i = 0; i < samples.length; ++i) {
+        const t = i / kSampleRate,
+            voiced = Math.floor(t) % 2 === 1,
+            tone = voiced ? 0.3 * Math.sin(2 * Math.PI * 220 * t) + 0.2 * Math.sin(2 * Math.PI * 660 * t) : 0
+
+        samples[i] = tone + 0.01 * noise()
+    }
+}
+
+/**
+ * Worker thread: analyse the shared signal and report the elapsed time
+ */
+function runWorker() {
+    const samples = new Float32Array(workerData.shared),
+        vad = new VAD(VAD.MODE_NORMAL, kSampleRate),
+        start = process.hrtime()
+    let offset = 0, voiced = 0
+
+    const next = () => {
+        if (offset >= samples.length) {
+            const elapsed = process.hrtime(start)
+            parentPort.postMessage({ seconds: elapsed[0] + elapsed[1] / 1e9, voiced: voiced })
+            return
+        }
+
+        // a view of the shared memory - no samples are copied
+        const chunk = samples.subarray(offset, Math.min(offset + kChunkSamples, samples.length))
+        offset += chunk.length
+
+        vad.processAudio(chunk, kSampleRate, (error, event) => {
+            if (error) throw error
+            if (event === VAD.EVENT_VOICE) ++voiced
+            next()
+        })
+    }
+
+    next()
+}
+
+/**
+ * Run the benchmark with the given number of worker threads
+ * @param {SharedArrayBuffer} shared Shared sample data
+ * @param {number} count Number of workers
+ * @returns {Promise<number>} Wall clock time in seconds
+ */
+function runBenchmark(shared, count) {
+    const start = process.hrtime(),
+        workers = []
+
+    for (let i = 0; i < count; ++i) {
+        workers.push(new Promise((resolve, reject) => {
+            const worker = new Worker(__filename, { workerData: { shared: shared } })
+            worker.once('message', resolve)
+            worker.once('error', reject)
+        }))
+    }
+
+    return Promise.all(workers).then(() => {
+        const elapsed = process.hrtime(start)
+        return elapsed[0] + elapsed[1] / 1e9
+    })
+}
+
+async function main() {
+    const seconds = parseInt(process.argv[2], 10) || 60,
+        maxWorkers = parseInt(process.argv[3], 10) || os.cpus().length,
+        shared = new SharedArrayBuffer(seconds * kSampleRate * Float32Array.BYTES_PER_ELEMENT)
+
+    generateSignal(new Float32Array(shared))
+
+    // the libuv thread pool runs the native work of all workers
+    console.info(`${seconds}s of audio, UV_THREADPOOL_SIZE=${process.env.UV_THREADPOOL_SIZE || 4}`)
+    console.info('workers\taudio s/s\tspeedup')
+
+    let baseline = 0
+    for (let count = 1; count <= maxWorkers; count *= 2) {
+        const elapsed = await runBenchmark(shared, count),
+            throughput = count * seconds / elapsed
+
+        baseline = baseline || throughput
+        console.info(`${count}\t${throughput.toFixed(0)}\t\t${(throughput / baseline).toFixed(2)}x`)
+    }
+}
+
+if (isMainThread) {
+    main().catch(error => {
+        console.error(error)
+        process.exit(1)
+    })
+} else {
+    runWorker()
+}
@@ -12,12 +12,26 @@ var binding     = require('./binding').mpa,    // native bindings
  * @param {Boolean} [options.decodeAsFloat] If true, the stream will be decoded
  *                  as Float, otherwise clipped Int16 samples will be returned
  * @param {Integer} [options.bufferSize] Output buffer size in bytes - use with caution!
+ *                  Setting this option disables pooled output blocks and copies
+ *                  each decoded frame into newly allocated buffers instead.
+ * @param {Integer} [options.poolSize] Maximum number of output blocks owned by the
+ *                  stream for recycling (default: 16)
  *
  * @fires DecoderStream#frameInfo
  * @fires DecoderStream#samples
  * @remarks
+ * Input chunks may also be Uint8Array views of a SharedArrayBuffer, which are decoded
+ * without copying; the written range must not be modified until it has been decoded.
  * The decoder will always return {@link Buffer} objects. For stereo files, the resulting
- * PCM samples will be interleaved, otherwise only the left channel will be populated.
+ * PCM samples will be interleaved, otherwise only the left channel will be populated and
+ * is passed as both channels of the 'samples' event.
+ * By default, each decoded frame is written into an output block of the exact frame size
+ * that is pushed as is. Consumers return blocks for reuse by passing them to
+ * {@link DecoderStream#release} once they are done with them; recycled blocks make the
+ * decode path free of per-frame JS allocations. Blocks that aren't released are left to
+ * the garbage collector like any other pushed buffer. The stream itself never retains
+ * more than poolSize blocks, i.e. at most poolSize * 4608 bytes (16-bit) or 9216 bytes
+ * (float). The 'samples' event receives copies of the channel data.
  */
 function DecoderStream(options)
 {
@@ -28,14 +42,15 @@ function DecoderStream(options)
 
     var bufferSize = 0
     this._options = options || {}
+    this._pooled = !this._options.bufferSize
 
     if (this._options.decodeAsFloat) {
         this._sampleSize = 4
-        this._decode = binding.decodeFrameFloat
+        this._decode = this._pooled ? binding.decodeFramePooledFloat : binding.decodeFrameFloat
         bufferSize = binding.MPA_FLOAT_BUFFER_SIZE
     } else {
         this._sampleSize = 2
-        this._decode = binding.decodeFrame
+        this._decode = this._pooled ? binding.decodeFramePooled : binding.decodeFrame
         bufferSize = binding.MPA_SAMPLE_BUFFER_SIZE
     }
 
@@ -54,6 +69,22 @@ function DecoderStream(options)
     this._firstFrame = true
     this._closed = false
     this._frameInfo = {}
+    this._decoding = false
+
+    // output blocks: all blocks owned by the stream, the free ones, a spare untracked block
+    // and the size of the next frame
+    this._poolSize = this._options.poolSize === undefined ? 16 : this._options.poolSize
+    this._blocks = []
+    this._freeBlocks = []
+    this._frameBytes = 0
+    this._block = null
+    this._spareBlock = null
+    this._status = new Int32Array(3)     // sample count, channels, block written
+    this._statusBuffer = Buffer.from(this._status.buffer)
+    this._input = null
+    this._inputLength = 0
+    this._transformCallback = null
+    this._onFrameDecoded = this._frameDecoded.bind(this)
 }
 
 inherits(DecoderStream, Transform)
@@ -107,6 +138,38 @@ DecoderStream.prototype.close = function(callback) {
     process.nextTick(this.emit.bind(this, 'close'))
 }
 
+/**
+ * @api public
+ * Save the decoder state (bit reservoir, synthesis buffers and buffered input)
+ * to a versioned checkpoint. Must not be called while a chunk is being decoded.
+ * @returns {Buffer} Checkpoint that can be passed to {@link DecoderStream#restore}
+ */
+DecoderStream.prototype.checkpoint = function() {
+    if (this._decoding) {
+        throw new Error('Cannot checkpoint while decoding')
+    }
+
+    return binding.saveDecoder(this._mpa)
+}
+
+/**
+ * @api public
+ * Restore the decoder state from a checkpoint. Decoding continues with the
+ * input that followed the checkpoint and yields bit-identical output.
+ * @param {Buffer} checkpoint Checkpoint created by {@link DecoderStream#checkpoint}
+ */
+DecoderStream.prototype.restore = function(checkpoint) {
+    if (this._decoding) {
+        throw new Error('Cannot restore while decoding')
+    }
+
+    if (!binding.restoreDecoder(this._mpa, checkpoint)) {
+        throw new Error('Invalid or incompatible decoder checkpoint')
+    }
+
+    this._frameInfo = binding.getLastFrameInfo(this._mpa) || {}
+}
+
 /**
  * @private
  * Interleave stereo samples (Int16)
@@ -137,6 +200,32 @@ function interleaveFloat(inter, left, right, bytes) {
     }
 }
 
+/**
+ * @private
+ * Get the output of a legacy decode run by copying the samples
+ */
+function getCopiedSamples(result, bytes, channels, sampleSize) {
+    var left = new Buffer(result.samplesLeft),
+        right = new Buffer(result.samplesRight),
+        data = {
+            left: left.slice(0, bytes),
+            right: right.slice(0, bytes)
+        }
+
+    if (channels > 1) {
+        data.interleaved = new Buffer(bytes * 2)
+        if (sampleSize === 2) {
+            interleaveShort(data.interleaved, left, right, bytes)
+        } else {
+            interleaveFloat(data.interleaved, left, right, bytes)
+        }
+    } else {
+        data.interleaved = data.right = data.left
+    }
+
+    return data
+}
+
 /**
  * @api private
  * Implements the actual transform by decoding the audio stream (async)
@@ -153,6 +242,10 @@ DecoderStream.prototype._transform = function(chunk, encoding, callback) {
         return callback()
     }
 
+    if (this._pooled) {
+        return this._decodePooled(chunk, callback)
+    }
+
     var haveSamples = false,
         inputLength = chunk.length
 
@@ -170,27 +263,10 @@ DecoderStream.prototype._transform = function(chunk, encoding, callback) {
             }
             if (haveSamples) {
                 var bytes = result.sampleCount * this._sampleSize,
-                    info = this._frameInfo,
-                    left = new Buffer(result.samplesLeft),
-                    right = new Buffer(result.samplesRight),
-                    data = {
-                        left: left.slice(0, bytes),
-                        right: right.slice(0, bytes)
-                    }
-
-                if (info.channels > 1) {
-                    var inter = new Buffer(bytes * 2)
-                    if (this._sampleSize === 2) {
-                        interleaveShort(inter, left, right, bytes)
-                    } else {
-                        interleaveFloat(inter, left, right, bytes)
-                    }
-                    this.push(inter)
-                } else {
-                    this.push(data.left)
-                }
-
-                this.emit('samples', data)
+                    data = getCopiedSamples(result, bytes, this._frameInfo.channels, this._sampleSize)
+
+                this.push(data.interleaved)
+                this.emit('samples', { left: data.left, right: data.right })
             }
             // subsequent calls only flush input buffers
             inputLength = 0
@@ -205,7 +281,179 @@ DecoderStream.prototype._transform = function(chunk, encoding, callback) {
         }
     }
 
-    async.doWhilst(decodeInput.bind(this), dataAvailable, callback)
+    function done(error) {
+        this._decoding = false
+        callback(error)
+    }
+
+    this._decoding = true
+    async.doWhilst(decodeInput.bind(this), dataAvailable, done.bind(this))
+}
+
+/**
+ * @api private
+ * Decodes a chunk frame by frame into output blocks. The decode state is kept
+ * in the stream, so no closures are created per frame.
+ */
+DecoderStream.prototype._decodePooled = function(chunk, callback) {
+    this._input = chunk
+    this._inputLength = chunk.length
+    this._transformCallback = callback
+    this._decoding = true
+    this._decodeNextFrame()
+}
+
+/**
+ * @api private
+ * Starts decoding the next frame into a block of the expected frame size
+ */
+DecoderStream.prototype._decodeNextFrame = function() {
+    this._block = this._frameBytes > 0 ? this._takeBlock(this._frameBytes) : null
+
+    try {
+        this._decode(this._mpa, this._input, this._inputLength, this._samplesLeft, this._samplesRight,
+            this._block, this._statusBuffer, this._onFrameDecoded)
+    } catch (error) {
+        this._finishPooled(error)
+    }
+}
+
+/**
+ * @api private
+ * Pushes a decoded frame and continues until the decoder needs more input
+ */
+DecoderStream.prototype._frameDecoded = function(error, frameInfo) {
+    var status = this._status,
+        count = status[0],
+        channels = status[1] > 1 ? 2 : 1,
+        block = this._block
+
+    this._block = null
+    if (frameInfo) {
+        this._frameInfo = frameInfo
+        this.emit('frameInfo', this._frameInfo)
+    }
+
+    if (count > 0) {
+        var bytes = count * this._sampleSize
+
+        if (!status[2]) {
+            // first frame or changed frame size - fill a block of the new size
+            this._keepBlock(block)
+            this._frameBytes = bytes * channels
+            block = this._takeBlock(this._frameBytes)
+            if (channels > 1 && this._sampleSize === 2) {
+                interleaveShort(block, this._samplesLeft, this._samplesRight, bytes)
+            } else if (channels > 1) {
+                interleaveFloat(block, this._samplesLeft, this._samplesRight, bytes)
+            } else {
+                this._samplesLeft.copy(block, 0, 0, bytes)
+            }
+        }
+
+        this.push(block)
+        if (this.listenerCount('samples') > 0) {
+            var left = Buffer.from(this._samplesLeft.slice(0, bytes))
+            this.emit('samples', {
+                left: left,
+                right: channels > 1 ? Buffer.from(this._samplesRight.slice(0, bytes)) : left
+            })
+        }
+    } else {
+        this._keepBlock(block)
+    }
+
+    // subsequent calls only flush input buffers
+    this._inputLength = 0
+
+    if (error || count <= 0) {
+        this._finishPooled(error)
+    } else {
+        this._decodeNextFrame()
+    }
+}
+
+/**
+ * @api private
+ * Completes the transform of the current chunk
+ */
+DecoderStream.prototype._finishPooled = function(error) {
+    var callback = this._transformCallback
+
+    this._input = null
+    this._transformCallback = null
+    this._decoding = false
+    callback(error)
+}
+
+/**
+ * @api private
+ * Takes a free output block of the given size or allocates a new one;
+ * blocks beyond the pool size aren't tracked and are left to the GC
+ */
+DecoderStream.prototype._takeBlock = function(size) {
+    var free = this._freeBlocks,
+        block = this._spareBlock
+
+    if (block && block.length === size) {
+        this._spareBlock = null
+        return block
+    }
+
+    for (var i = free.length - 1; i >= 0; --i) {
+        if (free[i].length === size) {
+            block = free[i]
+            free[i] = free[free.length - 1]
+            free.pop()
+            return block
+        }
+    }
+
+    if (this._blocks.length >= this._poolSize && free.length > 0) {
+        // make room for a block of the new size
+        this._blocks.splice(this._blocks.indexOf(free.pop()), 1)
+    }
+
+    // not taken from the shared allocation pool, so a block only holds its own frame
+    block = Buffer.allocUnsafeSlow(size)
+    if (this._blocks.length < this._poolSize) {
+        this._blocks.push(block)
+    }
+    return block
+}
+
+/**
+ * @api private
+ * Returns an unused block to the free list if it is owned by the stream
+ */
+DecoderStream.prototype._putBlock = function(block) {
+    if (block && this._blocks.indexOf(block) >= 0 && this._freeBlocks.indexOf(block) < 0) {
+        this._freeBlocks.push(block)
+        return true
+    }
+    return false
+}
+
+/**
+ * @api private
+ * Keeps a block that wasn't used for output for the next frame
+ */
+DecoderStream.prototype._keepBlock = function(block) {
+    if (block && !this._putBlock(block)) {
+        this._spareBlock = block
+    }
+}
+
+/**
+ * @api public
+ * Returns a buffer read from the stream for reuse by subsequent frames.
+ * The buffer must not be accessed afterwards.
+ * @param {Buffer} buffer Buffer read from the stream
+ * @returns {Boolean} true if the buffer was recycled, false if it wasn't
+ *                    an owned output block or has already been released
+ */
+DecoderStream.prototype.release = function(buffer) {
+    return this._pooled && this._putBlock(buffer)
 }
 
 /**
@@ -217,6 +465,54 @@ function createDecoder(options) {
     return new DecoderStream(options)
 }
 
+/**
+ * @api public
+ * Determine the properties of an MPEG audio stream without decoding it.
+ * Reads the Xing/Info/LAME tag if present, otherwise walks the frame headers.
+ * @param {Buffer|Uint8Array|String} input Buffer or view containing the stream or path of a file
+ * @param {Object} [options] Probe options
+ * @param {Boolean} [options.fullScan] Walk all frames even if a VBR tag is present
+ *                  (required for minimum and maximum bitrate of VBR streams)
+ * @param {DecoderStream~probeCallback} callback Async callback that is invoked after completion
+ */
+function probe(input, options, callback) {
+    if (typeof options === 'function') {
+        callback = options
+        options = {}
+    }
+
+    if (!callback || typeof callback !== 'function') {
+        throw new Error('Callback must be a function')
+    }
+
+    options = options || {}
+
+    var flags = options.fullScan ? binding.PROBE_FULL_SCAN : 0
+
+    binding.probe(input, flags, callback)
+}
+
+/**
+ * This callback provides the stream properties found by {@link probe}.
+ * @callback DecoderStream~probeCallback
+ * @param {Object|Null} error    Error that occurred during the operation
+ * @param {Object}      info     Stream properties
+ * @param {Number}      info.duration Playback duration in seconds (without encoder delay and padding)
+ * @param {Integer}     info.bitrate Average bitrate in kbps
+ * @param {Integer}     info.minBitrate Lowest frame bitrate in kbps (0 if unknown)
+ * @param {Integer}     info.maxBitrate Highest frame bitrate in kbps (0 if unknown)
+ * @param {Integer}     info.channels Number of channels in the stream (1: mono, 2: stereo}
+ * @param {Integer}     info.samplerate Number of samples per second (frequency in Hz)
+ * @param {Integer}     info.layer MPEG.x Layer (1: Layer I, 2: Layer II, 3: layer III)
+ * @param {String}      info.version MPEG stream version ('MPEG1', 'MPEG2' or 'MPEG2.5')
+ * @param {Integer}     info.mode Stream stereo mode (0: Stereo, 1: Joint Stereo, 2: Dual Channel, 3: Mono)
+ * @param {Integer}     info.frameCount Number of audio frames
+ * @param {Integer}     info.sampleCount Number of decoded samples per channel
+ * @param {Integer}     info.encoderDelay Encoder delay in samples (-1 if unknown)
+ * @param {Integer}     info.encoderPadding Encoder padding in samples (-1 if unknown)
+ * @param {Boolean}     info.vbrHeader True if a Xing/Info tag was found
+ */
+
 /**
  *    Fires whenever the stream properties change.
  *    This event is useful for getting sample rate,
@@ -240,7 +536,7 @@ function createDecoder(options) {
  *    @event DecoderStream#samples
  *    @type {object}
  *    @property {Buffer} left Decoded samples of the left channel
- *    @property {Buffer} [right] Decoded samples of the right channel (stereo only)
+ *    @property {Buffer} right Decoded samples of the right channel (same as left for mono streams)
  *    @property {Object} [frameInfo] Frame information (available only if changed)
  *                                   see {@link DecoderStream#frameInfo} for contents
  */
@@ -248,5 +544,6 @@ function createDecoder(options) {
 // Exports
 module.exports = {
     DecoderStream: DecoderStream,
-    createDecoder: createDecoder
+    createDecoder: createDecoder,
+    probe:         probe
 }
@@ -1,6 +1,7 @@
 var binding         = require('./binding').vad,        // native bindings
     inherits        = require('util').inherits,
-    EventEmitter    = require('events').EventEmitter
+    EventEmitter    = require('events').EventEmitter,
+    Duplex          = require('stream').Duplex
 
 /**
  * @api public
@@ -31,41 +32,85 @@ function toFloatArray(buffer) {
     }
 }
 
+/**
+ * @private
+ * Get a buffer view of the given sample data without copying it.
+ * Accepts Buffers, typed arrays and DataViews, as well as plain or
+ * shared array buffers (e.g. a SharedArrayBuffer passed to a worker thread)
+ */
+function toBufferView(samples) {
+    if (Buffer.isBuffer(samples)) {
+        return samples
+    }
+
+    if (ArrayBuffer.isView(samples)) {
+        return Buffer.from(samples.buffer, samples.byteOffset, samples.byteLength)
+    }
+
+    if (samples instanceof ArrayBuffer ||
+        (typeof SharedArrayBuffer !== 'undefined' && samples instanceof SharedArrayBuffer)) {
+        return Buffer.from(samples)
+    }
+
+    throw new Error('Invalid audio buffer')
+}
+
 /**
  * @api public
  * @class
  * Provides simple Voice Activity Detection
  * @param {Number} [mode] Voice detection mode
+ * @param {Number} [samplerate] Sample rate the instance will be used with;
+ *                 reduces the memory footprint for lower rates if given
  */
-function VAD(mode) {
+function VAD(mode, samplerate) {
     if (!(this instanceof VAD)) {
         throw new Error('Must be called with "new"')
     }
 
-    var res = binding.vad_alloc(null)
-    if (res.error) {
+    var res = binding.vad_alloc(null, samplerate)
+    if (res.error || !res.size) {
         throw new Error('Failed to get VAD size')
     }
 
-    this._vad = new Buffer(res.size)
-    res = binding.vad_alloc(this._vad)
-    if (!res) {
+    var handle = new Buffer(res.size)
+    res = binding.vad_alloc(handle, samplerate)
+    if (!res || res.error) {
         throw new Error('Failed to allocate VAD')
     }
 
-    res = binding.vad_init(this._vad)
+    res = binding.vad_init(handle)
     if (!res) {
         throw new Error('Failed to initialise VAD')
     }
 
-    if (typeof mode === 'number' &&
-        mode >= VAD.MODE_NORMAL && mode <= VAD.MODE_VERY_AGGRESSIVE) {
-        binding.vad_setmode(this._vad, mode)
-    } else if (typeof mode !== 'undefined') {
-        throw new Error('Invalid mode settings')
+    initialiseVAD(this, handle, mode)
+}
+
+/**
+ * @private
+ * Attach a native VAD state to the given instance and apply the mode
+ */
+function initialiseVAD(vad, handle, mode) {
+    checkMode(mode)
+    vad._vad = handle
+
+    if (typeof mode !== 'undefined') {
+        binding.vad_setmode(vad._vad, mode)
     }
 
-    this._processQueue = []
+    vad._processQueue = []
+}
+
+/**
+ * @private
+ * Throws if the given optional mode is invalid
+ */
+function checkMode(mode) {
+    if (typeof mode !== 'undefined' && !(typeof mode === 'number' &&
+        mode >= VAD.MODE_NORMAL && mode <= VAD.MODE_VERY_AGGRESSIVE)) {
+        throw new Error('Invalid mode settings')
+    }
 }
 
 inherits(VAD, EventEmitter)
@@ -126,10 +171,40 @@ VAD.prototype._dequeueItem = function() {
         process.nextTick(this._dequeueItem.bind(this))
     }
 
+    function completeBatchAndDequeueNext(err, buffer, counts) {
+        // the batch stays queued while its callback runs, so batches
+        // queued by the callback are started on the next tick only
+        this._processQueue[0].callback(err, buffer, counts)
+        this._processQueue.shift()
+
+        // continue on the next tick
+        process.nextTick(this._dequeueItem.bind(this))
+    }
+
     if (this._processQueue.length > 0) {
         var entry = this._processQueue[0]
-        binding.vad_processAudio(this._vad, entry.samples, entry.rate,
-            evaluateAndDequeueNext.bind(this))
+        if (entry.chunks) {
+            binding.vad_processFrames(this._vad, entry.chunks, entry.rate,
+                completeBatchAndDequeueNext.bind(this))
+        } else {
+            binding.vad_processAudio(this._vad, entry.samples, entry.rate,
+                evaluateAndDequeueNext.bind(this))
+        }
+    }
+}
+
+/**
+ * @api private
+ * @function
+ * Queues a batch of chunks for per-frame analysis in a single native call.
+ * Batches share the processing queue with processAudio(), so the state
+ * isn't changed while a batch is running. No events are emitted.
+ */
+VAD.prototype._processFrames = function(chunks, samplerate, callback) {
+    this._processQueue.push({ chunks: chunks, rate: samplerate, callback: callback })
+
+    if (this._processQueue.length === 1) {
+        this._dequeueItem()
     }
 }
 
@@ -138,7 +213,9 @@ VAD.prototype._dequeueItem = function() {
  * @function
  * Analyses the given buffer and returns voice or silence.
  *
- * @param    {Buffer}            samples     Signal to analyse (containing normalised float samples)
+ * @param    {Buffer|Float32Array|SharedArrayBuffer} samples Signal to analyse (containing normalised
+ *                                  float samples); array buffers and views are used without copying
+ *                                  and must not be modified until the callback has been invoked
  * @param    {Number}            samplerate  Sample rate of the signal in Hz
  * @param    {VAD~asyncCallback} callback    Async callback that is invoked after completion
  */
@@ -147,13 +224,643 @@ VAD.prototype.processAudio = function(samples, samplerate, callback) {
         throw new Error('Callback must be a function')
     }
 
-    this._processQueue.push({ samples: samples, rate: samplerate, callback: callback })
+    if (this._pool && !this._acquired) {
+        throw new Error('VAD instance has been released')
+    }
+
+    this._processQueue.push({ samples: toBufferView(samples), rate: samplerate, callback: callback })
+
+    if (this._processQueue.length === 1) {
+        this._dequeueItem()
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Resets the detector for a new stream, keeping the detection mode.
+ * No memory is allocated.
+ */
+VAD.prototype.reset = function() {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot reset while audio is being processed')
+    }
+
+    if (!binding.vad_reset(this._vad)) {
+        throw new Error('Failed to reset VAD')
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Saves the detector state (model, filter states, buffered samples and
+ * pre-gate settings and statistics) to a versioned checkpoint.
+ *
+ * @returns {Buffer} Checkpoint that can be passed to {@link VAD#restore}
+ */
+VAD.prototype.checkpoint = function() {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot checkpoint while audio is being processed')
+    }
+
+    return binding.vad_save(this._vad)
+}
+
+/**
+ * @api public
+ * @function
+ * Restores the detector state from a checkpoint. Processing continues
+ * exactly where the checkpoint was taken.
+ *
+ * @param {Buffer} checkpoint Checkpoint created by {@link VAD#checkpoint}
+ */
+VAD.prototype.restore = function(checkpoint) {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot restore while audio is being processed')
+    }
+
+    if (!binding.vad_load(this._vad, checkpoint)) {
+        throw new Error('Invalid or incompatible VAD checkpoint')
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Enables or disables the energy pre-gate. Frames that are clearly silent
+ * according to the enabled criteria bypass the detector and yield
+ * {@link VAD.EVENT_SILENCE}. Omitted criteria are disabled.
+ *
+ * @param {Object|Null} options           Gate thresholds, null disables the gate
+ * @param {Number}      [options.peak]    Maximum absolute sample value (int16)
+ * @param {Number}      [options.energy]  Maximum mean squared sample value (int16)
+ * @param {Number}      [options.dcRange] Maximum sample range of frames
+ *                                        without zero crossings (int16)
+ */
+VAD.prototype.setGate = function(options) {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot change the gate while audio is being processed')
+    }
+
+    var args = [this._vad].concat(gateArgs(options))
+    if (!binding.vad_setgate.apply(binding, args)) {
+        throw new Error('Invalid gate options')
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Returns the pre-gate statistics since the last reset.
+ *
+ * @returns {Object} { skipped: Number, frames: Number } frames that
+ *                   bypassed the detector and total frames processed
+ */
+VAD.prototype.getGateStats = function() {
+    return binding.vad_gate_stats(this._vad)
+}
+
+function gateArgs(options) {
+    if (!options) {
+        return [null]
+    }
+    if (typeof options !== 'object') {
+        throw new TypeError('Gate options must be an object or null')
+    }
+
+    return [options.peak, options.energy, options.dcRange].map(function(value) {
+        return typeof value === 'number' ? value : -1
+    })
+}
+
+/**
+ * @api public
+ * @class
+ * Pool of VAD instances that share a single preallocated native slab.
+ * Acquired instances are reset in place and returned to the pool via
+ * {@link VADPool#release}, so session churn causes no allocations.
+ * @param {Number} size       Number of VAD instances in the pool
+ * @param {Number} samplerate Sample rate of all pooled instances in Hz
+ */
+function VADPool(size, samplerate) {
+    if (!(this instanceof VADPool)) {
+        throw new Error('Must be called with "new"')
+    }
+
+    var res = binding.vad_pool_alloc(null, size, samplerate)
+    if (res.error) {
+        throw new Error('Invalid pool size or sample rate')
+    }
+
+    this._slab = new Buffer(res.size)
+    res = binding.vad_pool_alloc(this._slab, size, samplerate)
+    if (res.error) {
+        throw new Error('Failed to allocate VAD pool')
+    }
+
+    this._slotSize = res.slotSize
+    this._samplerate = samplerate
+    this._size = size
+    this._available = size
+}
+
+/**
+ * @api public
+ * @function
+ * Takes a VAD instance from the pool
+ *
+ * @param {Number} [mode] Voice detection mode
+ * @returns {VAD|null} Freshly reset VAD instance or null if the pool is exhausted
+ */
+VADPool.prototype.acquire = function(mode) {
+    // validate before taking a slot, so it can't leak
+    checkMode(mode)
+
+    var offset = binding.vad_pool_acquire(this._slab)
+    if (offset < 0) {
+        return null
+    }
+
+    // each owner gets a wrapper of its own, so stale references stay invalid
+    var vad = Object.create(VAD.prototype)
+    EventEmitter.call(vad)
+    vad._pool = this
+    vad._poolOffset = offset
+    initialiseVAD(vad, this._slab.slice(offset, offset + this._slotSize), mode)
+
+    vad._acquired = true
+    --this._available
+    return vad
+}
+
+/**
+ * @api public
+ * @function
+ * Returns a VAD instance to the pool. The instance must not be used afterwards.
+ *
+ * @param {VAD} vad Instance returned by {@link VADPool#acquire}
+ */
+VADPool.prototype.release = function(vad) {
+    if (!vad || vad._pool !== this || !vad._acquired) {
+        throw new Error('VAD instance does not belong to this pool')
+    }
+
+    if (vad._processQueue.length > 0) {
+        throw new Error('Cannot release while audio is being processed')
+    }
+
+    if (!binding.vad_pool_release(this._slab, vad._poolOffset)) {
+        throw new Error('Failed to release VAD instance')
+    }
+
+    vad.removeAllListeners()
+    vad._acquired = false
+    vad._vad = null
+    ++this._available
+}
+
+/**
+ * @api public
+ * @readonly
+ * @property {Number} VADPool#available Number of instances that can be acquired
+ */
+Object.defineProperty(VADPool.prototype, 'available', {
+    get: function() { return this._available }
+})
+
+/**
+ * @api public
+ * @class
+ * Provides Voice Activity Detection for interleaved multi-channel audio.
+ * Each channel is analysed independently, but all channels are processed
+ * with a single call.
+ * @param {Number} channels     Number of interleaved channels
+ * @param {Number} [mode]       Voice detection mode
+ * @param {Number} [samplerate] Sample rate the instance will be used with;
+ *                 reduces the memory footprint for lower rates if given
+ */
+function MultiChannelVAD(channels, mode, samplerate) {
+    if (!(this instanceof MultiChannelVAD)) {
+        throw new Error('Must be called with "new"')
+    }
+
+    if (typeof channels !== 'number' || channels < 1 || channels > binding.VAD_MAX_CHANNELS) {
+        throw new Error('Invalid number of channels')
+    }
+
+    var res = binding.vad_multi_alloc(null, channels, samplerate)
+    if (res.error || !res.size) {
+        throw new Error('Failed to get VAD size')
+    }
+
+    this._vad = new Buffer(res.size)
+    res = binding.vad_multi_alloc(this._vad, channels, samplerate)
+    if (!res || res.error) {
+        throw new Error('Failed to allocate VAD')
+    }
+
+    if (typeof mode === 'number' &&
+        mode >= VAD.MODE_NORMAL && mode <= VAD.MODE_VERY_AGGRESSIVE) {
+        binding.vad_multi_setmode(this._vad, mode)
+    } else if (typeof mode !== 'undefined') {
+        throw new Error('Invalid mode settings')
+    }
+
+    this._channels = channels
+    this._processQueue = []
+    EventEmitter.call(this)
+}
+
+inherits(MultiChannelVAD, EventEmitter)
+
+/**
+ * @api public
+ * @static
+ * @readonly
+ * @property {Number} MultiChannelVAD.FORMAT_FLOAT Constant for normalised 32bit float samples
+ * @property {Number} MultiChannelVAD.FORMAT_INT16 Constant for signed 16bit integer samples
+ */
+Object.defineProperty(MultiChannelVAD, 'FORMAT_FLOAT', { value: 0, writable: false })
+Object.defineProperty(MultiChannelVAD, 'FORMAT_INT16', { value: 1, writable: false })
+
+/**
+ * @api private
+ * @function
+ * Processes the next item in the processing queue
+ */
+MultiChannelVAD.prototype._dequeueItem = function() {
+    var EVENT_MAP = ['error', 'silence', 'voice', 'noise']
+
+    function evaluateAndDequeueNext(err, res) {
+        var item = this._processQueue.shift()
+
+        this.emit('event', res)
+
+        for (var channel = 0; channel < res.length; ++channel) {
+            var index = res[channel] + 1
+            if (index >= 0 && index < EVENT_MAP.length) {
+                this.emit(EVENT_MAP[index], res[channel], channel)
+            }
+        }
+
+        try {
+            item.callback(err, res)
+        } catch(e) {
+            this.emit('error', e)
+        }
+
+        // continue on the next tick
+        process.nextTick(this._dequeueItem.bind(this))
+    }
+
+    if (this._processQueue.length > 0) {
+        var entry = this._processQueue[0]
+        binding.vad_processInterleaved(this._vad, entry.samples, entry.rate, entry.format,
+            evaluateAndDequeueNext.bind(this))
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Analyses the given interleaved samples and returns voice or silence per channel.
+ * Int16Array input is processed as 16bit integer samples, any other input as
+ * normalised float samples. Trailing partial sample frames are ignored.
+ *
+ * @param    {Buffer|Float32Array|Int16Array} samples Interleaved signal to analyse
+ * @param    {Number}            samplerate  Sample rate of the signal in Hz
+ * @param    {MultiChannelVAD~asyncCallback} callback Async callback that is invoked after completion
+ */
+MultiChannelVAD.prototype.processAudio = function(samples, samplerate, callback) {
+    if (!callback || typeof callback !== 'function') {
+        throw new Error('Callback must be a function')
+    }
+
+    var format = samples instanceof Int16Array ?
+        MultiChannelVAD.FORMAT_INT16 : MultiChannelVAD.FORMAT_FLOAT
+
+    this._processQueue.push({
+        samples: toBufferView(samples), rate: samplerate, format: format, callback: callback
+    })
 
     if (this._processQueue.length === 1) {
         this._dequeueItem()
     }
 }
 
+/**
+ * @api public
+ * @function
+ * Resets all channels for a new stream, keeping the detection mode.
+ */
+MultiChannelVAD.prototype.reset = function() {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot reset while audio is being processed')
+    }
+
+    if (!binding.vad_multi_reset(this._vad)) {
+        throw new Error('Failed to reset VAD')
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Enables or disables the energy pre-gate of all channels.
+ * See {@link VAD#setGate}.
+ *
+ * @param {Object|Null} options Gate thresholds, null disables the gate
+ */
+MultiChannelVAD.prototype.setGate = function(options) {
+    if (this._processQueue.length > 0) {
+        throw new Error('Cannot change the gate while audio is being processed')
+    }
+
+    var args = [this._vad].concat(gateArgs(options))
+    if (!binding.vad_multi_setgate.apply(binding, args)) {
+        throw new Error('Invalid gate options')
+    }
+}
+
+/**
+ * @api public
+ * @function
+ * Returns the pre-gate statistics summed over all channels.
+ *
+ * @returns {Object} { skipped: Number, frames: Number }
+ */
+MultiChannelVAD.prototype.getGateStats = function() {
+    return binding.vad_multi_gate_stats(this._vad)
+}
+
+/**
+ * @api public
+ * @readonly
+ * @property {Number} MultiChannelVAD#channels Number of interleaved channels
+ */
+Object.defineProperty(MultiChannelVAD.prototype, 'channels', {
+    get: function() { return this._channels }
+})
+
+/**
+ * @api public
+ * @class
+ * Duplex stream that provides a voice activity decision for each audio frame.
+ * Normalised 32bit float samples are written to the stream and
+ * {@link VADStream~FrameResult} objects can be read from it (or iterated
+ * using `for await`). Chunks that are queued while the detector is busy
+ * are coalesced and analysed in a single native call.
+ * @param {Object} options
+ * @param {Number} options.samplerate               Sample rate of the input in Hz
+ * @param {Number} [options.mode]                   Voice detection mode
+ * @param {Number} [options.highWaterMark]          Number of queued input bytes
+ *                                                  at which write() returns false
+ * @param {Number} [options.readableHighWaterMark]  Number of results buffered on
+ *                                                  the readable side (default: 16)
+ * @remarks
+ * Chunks must contain whole samples. Array buffers and views are analysed
+ * without copying and must not be modified until they have been processed.
+ * Written chunks are held back while the readable side is full; results of
+ * {@link VADStream#process} calls are resolved regardless and not pushed
+ * unless the readable side is consumed.
+ */
+function VADStream(options) {
+    if (!(this instanceof VADStream)) {
+        throw new Error('Must be called with "new"')
+    }
+
+    options = options || {}
+
+    if (VALID_RATES.indexOf(options.samplerate) < 0) {
+        throw new Error('Invalid sample rate')
+    }
+
+    Duplex.call(this, {
+        writableHighWaterMark: options.highWaterMark,
+        readableHighWaterMark: options.readableHighWaterMark || 16,
+        readableObjectMode: true
+    })
+
+    this._vad = new VAD(options.mode, options.samplerate)
+    this._samplerate = options.samplerate
+    this._frames = 0
+    this._pending = []
+    this._continue = null
+    this._needDrain = false
+
+    this.on('drain', function() {
+        this._needDrain = false
+    })
+}
+
+inherits(VADStream, Duplex)
+
+var VALID_RATES = [8000, 16000, 32000, 48000]
+
+/**
+ * @api public
+ * @static
+ * @readonly
+ * @property {Number} VADStream.FRAME_DURATION Duration of an analysed frame in ms
+ */
+Object.defineProperty(VADStream, 'FRAME_DURATION', { value: binding.VAD_FRAME_DURATION, writable: false })
+
+/**
+ * @api public
+ * @readonly
+ * @property {VAD} VADStream#vad Underlying detector, e.g. for {@link VAD#setGate};
+ *                               its processAudio() must not be used. Methods that
+ *                               change the state throw while a batch is analysed.
+ */
+Object.defineProperty(VADStream.prototype, 'vad', {
+    get: function() { return this._vad }
+})
+
+/**
+ * @api public
+ * @function
+ * Writes samples to the stream. Besides buffers, Float32Arrays and
+ * (shared) array buffers are accepted.
+ *
+ * @returns {Boolean} false if the queued input exceeds the high water mark
+ */
+VADStream.prototype.write = function(chunk, encoding, callback) {
+    if (chunk !== null && typeof chunk === 'object' && !Buffer.isBuffer(chunk)) {
+        chunk = toBufferView(chunk)
+    }
+
+    var ok = Duplex.prototype.write.call(this, chunk, encoding, callback)
+    this._needDrain = !ok
+    return ok
+}
+
+/**
+ * @api public
+ * @function
+ * Analyses the given samples.
+ *
+ * @param    {Buffer|Float32Array|SharedArrayBuffer} samples Signal to analyse (containing normalised
+ *                                                   float samples)
+ * @returns  {Promise<Int8Array>} Event codes of the frames completed by the samples
+ */
+VADStream.prototype.process = function(samples) {
+    var self = this,
+        chunk = toBufferView(samples)
+
+    if (chunk === samples) {
+        // make the chunk identifiable even if the buffer is written more than once
+        chunk = Buffer.from(chunk.buffer, chunk.byteOffset, chunk.length)
+    }
+
+    return new Promise(function(resolve, reject) {
+        self._pending.push({ chunk: chunk, resolve: resolve, reject: reject })
+        self.write(chunk)
+    })
+}
+
+/**
+ * @api public
+ * @function
+ * Waits until queued input has dropped below the high water mark.
+ *
+ * @returns {Promise} Resolves when more input can be written
+ */
+VADStream.prototype.ready = function() {
+    var self = this
+
+    return new Promise(function(resolve) {
+        if (self._needDrain) {
+            self.once('drain', resolve)
+        } else {
+            resolve()
+        }
+    })
+}
+
+/**
+ * @api private
+ * Analyses a batch of chunks in a single native call
+ */
+VADStream.prototype._processBatch = function(chunks, callback) {
+    var self = this
+
+    for (var i = 0; i < chunks.length; ++i) {
+        if (chunks[i].length % Float32Array.BYTES_PER_ELEMENT) {
+            return this._fail(chunks, new Error('Chunks must contain whole samples'), callback)
+        }
+    }
+
+    this._vad._processFrames(chunks, this._samplerate, function(err, buffer, counts) {
+        if (err) {
+            return self._fail(chunks, err, callback)
+        }
+
+        var events = new Int8Array(buffer.buffer, buffer.byteOffset, buffer.length),
+            offset = 0,
+            settled = 0
+
+        chunks.forEach(function(chunk, index) {
+            var count = counts[index]
+
+            if (self._pending.length > 0 && self._pending[0].chunk === chunk) {
+                self._pending.shift().resolve(events.subarray(offset, offset + count))
+                ++settled
+            }
+            offset += count
+        })
+
+        var result = {
+            frame: self._frames,
+            time: self._frames * VADStream.FRAME_DURATION / 1000,
+            events: events
+        }
+        self._frames += events.length
+
+        // results of process() calls are delivered by their promises and only
+        // pushed if the readable side is consumed (piped, listened to or iterated)
+        if (events.length === 0 || (settled === chunks.length && self.readableFlowing === null)) {
+            return callback()
+        }
+
+        // hold back further input until the reader catches up
+        if (self.push(result)) {
+            callback()
+        } else {
+            self._continue = callback
+        }
+    })
+}
+
+/**
+ * @api private
+ * Rejects the promises of the given chunks and reports the error
+ */
+VADStream.prototype._fail = function(chunks, error, callback) {
+    this._pending = this._pending.filter(function(entry) {
+        if (chunks.indexOf(entry.chunk) < 0) {
+            return true
+        }
+        entry.reject(error)
+        return false
+    })
+
+    callback(error)
+}
+
+/**
+ * @api private
+ * Implements the writable stream interface
+ */
+VADStream.prototype._write = function(chunk, encoding, callback) {
+    this._processBatch([chunk], callback)
+}
+
+/**
+ * @api private
+ * Implements the writable stream interface for queued chunks
+ */
+VADStream.prototype._writev = function(chunks, callback) {
+    this._processBatch(chunks.map(function(entry) { return entry.chunk }), callback)
+}
+
+/**
+ * @api private
+ * Implements the writable stream interface
+ */
+VADStream.prototype._final = function(callback) {
+    this.push(null)
+    callback()
+}
+
+/**
+ * @api private
+ * Implements the readable stream interface
+ */
+VADStream.prototype._read = function() {
+    var callback = this._continue
+
+    if (callback) {
+        this._continue = null
+        callback()
+    }
+}
+
+/**
+ * @api private
+ * Rejects all outstanding promises
+ */
+VADStream.prototype._destroy = function(error, callback) {
+    var pending = this._pending
+
+    this._pending = []
+    pending.forEach(function(entry) {
+        entry.reject(error || new Error('Stream destroyed'))
+    })
+
+    callback(error)
+}
+
 /**
  * @api public
  * @function
@@ -166,6 +873,39 @@ function createVAD(mode) {
     return new VAD(mode)
 }
 
+/**
+ * @api public
+ * @function
+ * Creates a new pool of Voice Activity Detection objects
+ *
+ * @param {Number} size       Number of VAD instances in the pool
+ * @param {Number} samplerate Sample rate of all pooled instances in Hz
+ * @returns {VADPool}
+ */
+function createVADPool(size, samplerate) {
+    return new VADPool(size, samplerate)
+}
+
+/**
+ * @api public
+ * @function
+ * Creates a new per-frame Voice Activity Detection stream
+ *
+ * @param {Object} options See {@link VADStream}
+ * @returns {VADStream}
+ */
+function createVADStream(options) {
+    return new VADStream(options)
+}
+
+/**
+ * Result of a batch of frames read from a {@link VADStream}.
+ * @typedef {Object} VADStream~FrameResult
+ * @property {Number}    frame  Index of the first frame in the batch
+ * @property {Number}    time   Start time of the first frame in seconds
+ * @property {Int8Array} events Event code of each frame
+ */
+
 /**
  * This callback notifies the detected voice event for the processed audio.
  * @callback VAD~asyncCallback
@@ -173,8 +913,20 @@ function createVAD(mode) {
  * @param {VoiceEvent}  result   VAD event that was generated by the audio
  */
 
+/**
+ * This callback notifies the detected voice events of all channels.
+ * @callback MultiChannelVAD~asyncCallback
+ * @param {Object|Null}  error   Error that occurred during the operation
+ * @param {VoiceEvent[]} result  VAD event of each channel
+ */
+
 module.exports = {
-    VAD:            VAD,
-    createVAD:      createVAD,
-    toFloatArray:   toFloatArray
+    VAD:             VAD,
+    VADPool:         VADPool,
+    MultiChannelVAD: MultiChannelVAD,
+    VADStream:       VADStream,
+    createVAD:       createVAD,
+    createVADPool:   createVADPool,
+    createVADStream: createVADStream,
+    toFloatArray:    toFloatArray
 }
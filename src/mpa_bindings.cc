@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
 #include <nan.h>
+#include <uv.h>
 #include "mpadec.h"
 
 /**
@@ -12,11 +16,16 @@
  */
 using namespace v8;
 
+using std::string;
 using std::transform;
+using std::vector;
 
 namespace mpa
 {
 
+// max. number of samples per channel in a decoded frame
+static const int MP3_FRAME_SIZE = 1152;
+
 /**
  * Get cached frame info from the decoder state buffer
  * @param handle    Decoder state handle
@@ -144,20 +153,7 @@ public:
         Nan::HandleScope scope;
         Local<Value> left = GetFromPersistent("left");
         Local<Value> right = GetFromPersistent("right");
-        Local<Object> obj = Nan::New<Object>();
-
-        Nan::Set(obj, Nan::New("sampleCount").ToLocalChecked(), Nan::New(samplesRead));
-        Nan::Set(obj, Nan::New("needMoreData").ToLocalChecked(), Nan::New(needData));
-        Nan::Set(obj, Nan::New("error").ToLocalChecked(), Nan::New(isError));
-
-        // only pass frame info if the parsed portion differs from the last decode run
-        bool emitFrameInfo = IsNewFrameInfo(&data, lastFrame);
-        if (emitFrameInfo)
-        {
-            Nan::Set(obj, Nan::New("frameInfo").ToLocalChecked(), GetFrameInfoObject(data, sizeof(T) * 8));
-            *lastFrame = data;                        // cache the updated frame info
-            *(int*)(&lastFrame[1]) = sizeof(T) * 8; // set the bits per sample
-        }
+        Local<Object> obj = CreateResult();
 
         // only pass actual data if we have a fully decoded frame
         if (samplesRead)
@@ -174,7 +170,41 @@ public:
         callback->Call(2, argv); // -> callback(error, result)
     }
 
-private:
+protected:
+    /**
+     * Create the result object without sample data
+     */
+    Local<Object> CreateResult()
+    {
+        Local<Object> obj = Nan::New<Object>();
+
+        Nan::Set(obj, Nan::New("sampleCount").ToLocalChecked(), Nan::New(samplesRead));
+        Nan::Set(obj, Nan::New("needMoreData").ToLocalChecked(), Nan::New(needData));
+        Nan::Set(obj, Nan::New("error").ToLocalChecked(), Nan::New(isError));
+
+        Local<Value> frameInfo = NewFrameInfo();
+        if (!frameInfo->IsUndefined())
+        {
+            Nan::Set(obj, Nan::New("frameInfo").ToLocalChecked(), frameInfo);
+        }
+
+        return obj;
+    }
+
+    /**
+     * Create the frame info object if the parsed portion differs from the last decode run
+     */
+    Local<Value> NewFrameInfo()
+    {
+        if (!IsNewFrameInfo(&data, lastFrame))
+        {
+            return Nan::Undefined();
+        }
+
+        *lastFrame = data;                        // cache the updated frame info
+        *(int*)(&lastFrame[1]) = sizeof(T) * 8; // set the bits per sample
+        return GetFrameInfoObject(data, sizeof(T) * 8);
+    }
 
     // the API behaves really stupid - the very first frame returns nothing
     // (-> it seeks the first audio frame)
@@ -229,6 +259,251 @@ private:
     mp3data_struct* lastFrame;
 };
 
+/**
+ * Async worker that decodes a frame into the caller's channel buffers and
+ * writes the interleaved frame into a caller-provided output block of the
+ * exact frame size. The result is reported through a status array, so no
+ * JS objects are created unless the frame info changes.
+ */
+template<typename T>
+class PooledDecodeFrameWorker : public DecodeFrameWorker<T>
+{
+public:
+    // layout of the status array
+    enum { STATUS_SAMPLES, STATUS_CHANNELS, STATUS_WRITTEN, STATUS_SIZE };
+
+    PooledDecodeFrameWorker(Nan::Callback* callback, Local<Value> mp, Local<Value> input,
+                            Local<Value> left, Local<Value> right, Local<Value> block,
+                            Local<Value> status, int length)
+        : DecodeFrameWorker<T>(callback, mp, input, left, right, length),
+          block(node::Buffer::HasInstance(block) ? node::Buffer::Data(block) : NULL),
+          blockSize(node::Buffer::HasInstance(block) ? node::Buffer::Length(block) : 0),
+          status(reinterpret_cast<int32_t*>(node::Buffer::Data(status))),
+          written(false)
+    {
+        if (this->block)
+        {
+            this->SaveToPersistent(Nan::New("block").ToLocalChecked(), block);
+        }
+        this->SaveToPersistent(Nan::New("status").ToLocalChecked(), status);
+    }
+
+    /**
+     * Performs work in a separate thread.
+     */
+    void Execute()
+    {
+        DecodeFrameWorker<T>::Execute();
+
+        if (this->samplesRead <= 0 || !block)
+        {
+            return;
+        }
+
+        const int channels = this->data.stereo > 1 ? 2 : 1;
+        if (blockSize != static_cast<size_t>(this->samplesRead) * channels * sizeof(T))
+        {
+            return;     // frame size changed - the caller fills a block of the new size
+        }
+
+        T* out = reinterpret_cast<T*>(block);
+        if (channels > 1)
+        {
+            for (int i = 0; i < this->samplesRead; ++i)
+            {
+                out[2 * i + 0] = this->outLeft[i];
+                out[2 * i + 1] = this->outRight[i];
+            }
+        }
+        else
+        {
+            memcpy(out, this->outLeft, blockSize);
+        }
+        written = true;
+    }
+
+    /**
+     * Pass the results back to V8.
+     */
+    void HandleOKCallback()
+    {
+        Nan::HandleScope scope;
+
+        status[STATUS_SAMPLES] = this->samplesRead;
+        status[STATUS_CHANNELS] = this->data.stereo;
+        status[STATUS_WRITTEN] = written;
+
+        Local<Value> argv[] = {
+            Nan::Null(),
+            this->NewFrameInfo()
+        };
+
+        this->callback->Call(2, argv); // -> callback(error, frameInfo)
+    }
+
+private:
+    char*    block;
+    size_t   blockSize;
+    int32_t* status;
+    bool     written;
+};
+
+/**
+ * Create js object from the given stream properties
+ * @param data    Probe result
+ * @returns Stream properties wrapped as js object
+ */
+static Local<Object> GetProbeInfoObject(const mp3probe_struct& data)
+{
+    static const char* VERSIONS[] = { "MPEG1", "MPEG2", "MPEG2.5" };
+
+    Local<Object> info = Nan::New<Object>();
+    const char* version = VERSIONS[data.version % 3];
+
+    Nan::Set(info, Nan::New("duration").ToLocalChecked(), Nan::New(data.duration));
+    Nan::Set(info, Nan::New("bitrate").ToLocalChecked(), Nan::New(data.bitrate));
+    Nan::Set(info, Nan::New("minBitrate").ToLocalChecked(), Nan::New(data.min_bitrate));
+    Nan::Set(info, Nan::New("maxBitrate").ToLocalChecked(), Nan::New(data.max_bitrate));
+    Nan::Set(info, Nan::New("channels").ToLocalChecked(), Nan::New(data.stereo));
+    Nan::Set(info, Nan::New("samplerate").ToLocalChecked(), Nan::New(data.samplerate));
+    Nan::Set(info, Nan::New("layer").ToLocalChecked(), Nan::New(data.layer));
+    Nan::Set(info, Nan::New("version").ToLocalChecked(), Nan::New(version).ToLocalChecked());
+    Nan::Set(info, Nan::New("mode").ToLocalChecked(), Nan::New(data.mode));
+    Nan::Set(info, Nan::New("frameCount").ToLocalChecked(), Nan::New(data.totalframes));
+    Nan::Set(info, Nan::New("sampleCount").ToLocalChecked(), Nan::New(static_cast<double>(data.nsamp)));
+    Nan::Set(info, Nan::New("encoderDelay").ToLocalChecked(), Nan::New(data.enc_delay));
+    Nan::Set(info, Nan::New("encoderPadding").ToLocalChecked(), Nan::New(data.enc_padding));
+    Nan::Set(info, Nan::New("vbrHeader").ToLocalChecked(), Nan::New(data.vbr_header != 0));
+
+    return info;
+}
+
+/**
+ * Async worker for probing a stream buffer or file without decoding
+ */
+class ProbeWorker : public Nan::AsyncWorker
+{
+public:
+    // file input is read in chunks of this size
+    static const size_t FILE_CHUNK_SIZE = 1 << 20;
+
+    ProbeWorker(Nan::Callback* callback, Local<Value> input, int flags)
+        : AsyncWorker(callback), input(NULL), length(0), flags(flags)
+    {
+        memset(&data, 0, sizeof data);
+
+        if (node::Buffer::HasInstance(input))
+        {
+            this->input = reinterpret_cast<const unsigned char*>(node::Buffer::Data(input));
+            this->length = node::Buffer::Length(input);
+            SaveToPersistent(Nan::New("input").ToLocalChecked(), input);
+        }
+        else
+        {
+            Nan::Utf8String str(input);
+            path = *str ? *str : "";
+        }
+    }
+
+    ~ProbeWorker() {}
+
+    /**
+     * Performs work in a separate thread.
+     */
+    void Execute()
+    {
+        vector<char> state(hip_probe_init(NULL, 0));
+        hip_probe_t probe = reinterpret_cast<hip_probe_t>(&state[0]);
+        hip_probe_init(probe, flags);
+
+        int result = input ? ProbeBuffer(probe) : ProbeFile(probe);
+
+        if (result >= 0 && hip_probe_result(probe, &data) != 0)
+        {
+            SetErrorMessage("No MPEG audio stream found");
+        }
+    }
+
+    /**
+     * Pass the results back to V8.
+     */
+    void HandleOKCallback()
+    {
+        Nan::HandleScope scope;
+
+        Local<Value> argv[] = {
+            Nan::Null(),
+            GetProbeInfoObject(data)
+        };
+
+        callback->Call(2, argv); // -> callback(error, result)
+    }
+
+private:
+
+    int ProbeBuffer(hip_probe_t probe)
+    {
+        size_t consumed = 0;
+        int result = hip_probe_feed(probe, input, length, 1, &consumed);
+
+        if (result < 0)
+        {
+            SetErrorMessage("Unsupported stream format");
+        }
+
+        return result;
+    }
+
+    // read the file sequentially in large chunks; frame payloads are skipped
+    // by the probe, so only the unconsumed tail is carried over
+    int ProbeFile(hip_probe_t probe)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            SetErrorMessage("Failed to open input file");
+            return -1;
+        }
+
+        vector<unsigned char> chunk(FILE_CHUNK_SIZE);
+        size_t tail = 0;
+        int result = 1;
+
+        while (result > 0)
+        {
+            size_t bytesRead = fread(&chunk[tail], 1, chunk.size() - tail, file);
+            size_t available = tail + bytesRead;
+            size_t consumed = 0;
+            int eof = bytesRead < chunk.size() - tail;
+
+            if (eof && ferror(file))
+            {
+                SetErrorMessage("Failed to read input file");
+                result = -1;
+                break;
+            }
+
+            result = hip_probe_feed(probe, &chunk[0], available, eof, &consumed);
+            tail = available - consumed;
+            memmove(&chunk[0], &chunk[consumed], tail);
+
+            if (result < 0)
+            {
+                SetErrorMessage("Unsupported stream format");
+            }
+        }
+
+        fclose(file);
+        return result;
+    }
+
+    mp3probe_struct      data;
+    const unsigned char* input;
+    size_t               length;
+    string               path;
+    int                  flags;
+};
+
 // Wraps hip_decode_init
 NAN_METHOD(initDecoder)
 {
@@ -268,6 +543,78 @@ NAN_METHOD(freeDecoder)
     }
 }
 
+// Wraps hip_decode_save - the cached frame info is appended to the checkpoint
+NAN_METHOD(saveDecoder)
+{
+    Nan::HandleScope scope;
+
+    if (!node::Buffer::HasInstance(info[0]))
+    {
+        Nan::ThrowTypeError("Invalid argument");
+        return;
+    }
+
+    hip_t mp = reinterpret_cast<hip_t>(node::Buffer::Data(info[0]));
+    if (hip_validate(mp))
+    {
+        Nan::ThrowTypeError("Invalid decoder state!");
+        return;
+    }
+
+    const size_t FRAME_INFO_SIZE = sizeof(mp3data_struct) + sizeof(int);
+    int size = hip_decode_save(mp, NULL, 0);
+    if (size <= 0)
+    {
+        Nan::ThrowError("Failed to save decoder state");
+        return;
+    }
+
+    Local<Object> checkpoint = Nan::NewBuffer(static_cast<uint32_t>(size + FRAME_INFO_SIZE)).ToLocalChecked();
+    char* data = node::Buffer::Data(checkpoint);
+
+    if (hip_decode_save(mp, data, size) != 0)
+    {
+        Nan::ThrowError("Failed to save decoder state");
+        return;
+    }
+
+    memcpy(data + size, GetFrameInfo(info[0]), FRAME_INFO_SIZE);
+    info.GetReturnValue().Set(checkpoint);
+}
+
+// Wraps hip_decode_restore
+NAN_METHOD(restoreDecoder)
+{
+    Nan::HandleScope scope;
+
+    if (!(node::Buffer::HasInstance(info[0]) && node::Buffer::HasInstance(info[1])))
+    {
+        Nan::ThrowTypeError("Invalid argument");
+        return;
+    }
+
+    hip_t mp = reinterpret_cast<hip_t>(node::Buffer::Data(info[0]));
+    if (hip_validate(mp))
+    {
+        Nan::ThrowTypeError("Invalid decoder state!");
+        return;
+    }
+
+    const size_t FRAME_INFO_SIZE = sizeof(mp3data_struct) + sizeof(int);
+    const char* data = node::Buffer::Data(info[1]);
+    size_t length = node::Buffer::Length(info[1]);
+
+    if (length <= FRAME_INFO_SIZE ||
+        hip_decode_restore(mp, data, length - FRAME_INFO_SIZE) != 0)
+    {
+        info.GetReturnValue().Set(false);
+        return;
+    }
+
+    memcpy(GetFrameInfo(info[0]), data + length - FRAME_INFO_SIZE, FRAME_INFO_SIZE);
+    info.GetReturnValue().Set(true);
+}
+
 // Async function for frame decoding
 template<typename T>
 NAN_METHOD(decodeFrame)
@@ -297,6 +644,43 @@ NAN_METHOD(decodeFrame)
     Nan::AsyncQueueWorker(worker);
 }
 
+// Async function for frame decoding into caller-owned output blocks
+template<typename T>
+NAN_METHOD(decodeFramePooled)
+{
+    Nan::HandleScope scope;
+
+    const size_t CHANNEL_SIZE = MP3_FRAME_SIZE * sizeof(T);
+    const size_t STATUS_SIZE = PooledDecodeFrameWorker<T>::STATUS_SIZE * sizeof(int32_t);
+
+    if (!(node::Buffer::HasInstance(info[0]) && // decoder insance
+          node::Buffer::HasInstance(info[1]) && // input buffer
+          node::Buffer::HasInstance(info[3]) && // channel buffer left
+          node::Buffer::HasInstance(info[4]) && // channel buffer right
+          (info[5]->IsNull() || node::Buffer::HasInstance(info[5])) && // output block
+          node::Buffer::HasInstance(info[6]) && // status
+          info[7]->IsFunction()) ||
+        node::Buffer::Length(info[3]) < CHANNEL_SIZE || node::Buffer::Length(info[4]) < CHANNEL_SIZE ||
+        node::Buffer::Length(info[6]) < STATUS_SIZE)
+    {
+        Nan::ThrowTypeError("Invalid argument");
+        return;
+    }
+
+    hip_t mp = reinterpret_cast<hip_t>(node::Buffer::Data(info[0]));
+    if (hip_validate(mp))
+    {
+        Nan::ThrowTypeError("Invalid decoder state!");
+        return;
+    }
+
+    int length = Nan::To<int>(info[2]).FromJust();
+    Nan::Callback* callback = new Nan::Callback(info[7].As<Function>());
+
+    Nan::AsyncQueueWorker(new PooledDecodeFrameWorker<T>(callback, info[0], info[1], info[3], info[4],
+                                                         info[5], info[6], length));
+}
+
 // Query the most recent frame info
 NAN_METHOD(getLastFrameInfo)
 {
@@ -327,10 +711,32 @@ NAN_METHOD(getLastFrameInfo)
     }
 }
 
-// Setup the native exports
+// Async function for probing stream properties without decoding
+NAN_METHOD(probe)
+{
+    Nan::HandleScope scope;
+
+    if (!(node::Buffer::HasInstance(info[0]) || info[0]->IsString()) || !info[2]->IsFunction())
+    {
+        Nan::ThrowTypeError("Invalid argument");
+        return;
+    }
+
+    int flags = Nan::To<int>(info[1]).FromMaybe(0);
+    Nan::Callback* callback = new Nan::Callback(info[2].As<Function>());
+
+    Nan::AsyncQueueWorker(new ProbeWorker(callback, info[0], flags));
+}
+
+// One-time initialisation of the decoder's shared tables
+static uv_once_t tablesOnce = UV_ONCE_INIT;
+static void InitTables() { hip_init_tables(); }
+
+// Setup the native exports; runs once per environment (main thread and each worker thread)
 NAN_MODULE_INIT(init)
 {
-    const int MP3_FRAME_SIZE = 1152;
+    uv_once(&tablesOnce, InitTables);
+
 	Nan::ForceSet(target, Nan::New("MPA_INPUT_BUFFER_SIZE").ToLocalChecked(), Nan::New(4096),    // nicely align to page
         static_cast<PropertyAttribute>(ReadOnly|DontDelete));
     Nan::ForceSet(target, Nan::New("MPA_SAMPLE_BUFFER_SIZE").ToLocalChecked(),
@@ -339,14 +745,21 @@ NAN_MODULE_INIT(init)
     Nan::ForceSet(target, Nan::New("MPA_FLOAT_BUFFER_SIZE").ToLocalChecked(),
         Nan::New(static_cast<int>(MP3_FRAME_SIZE * sizeof(float))),
         static_cast<PropertyAttribute>(ReadOnly|DontDelete));
+    Nan::ForceSet(target, Nan::New("PROBE_FULL_SCAN").ToLocalChecked(), Nan::New(HIP_PROBE_FULL_SCAN),
+        static_cast<PropertyAttribute>(ReadOnly|DontDelete));
 
-    Nan::Export(target, "initDecoder",      initDecoder);
-    Nan::Export(target, "freeDecoder",      freeDecoder);
-    Nan::Export(target, "decodeFrame",      decodeFrame<int16_t>);
-    Nan::Export(target, "decodeFrameFloat", decodeFrame<float>);
-    Nan::Export(target, "getLastFrameInfo", getLastFrameInfo);
+    Nan::Export(target, "initDecoder",            initDecoder);
+    Nan::Export(target, "freeDecoder",            freeDecoder);
+    Nan::Export(target, "decodeFrame",            decodeFrame<int16_t>);
+    Nan::Export(target, "decodeFrameFloat",       decodeFrame<float>);
+    Nan::Export(target, "getLastFrameInfo",       getLastFrameInfo);
+    Nan::Export(target, "probe",                  probe);
+    Nan::Export(target, "saveDecoder",            saveDecoder);
+    Nan::Export(target, "restoreDecoder",         restoreDecoder);
+    Nan::Export(target, "decodeFramePooled",      decodeFramePooled<int16_t>);
+    Nan::Export(target, "decodeFramePooledFloat", decodeFramePooled<float>);
 }
 
 } //< mpa namespace
 
-NODE_MODULE(mpa, mpa::init)
+NAN_MODULE_WORKER_ENABLED(mpa, mpa::init)
@@ -2,6 +2,10 @@
 #include <stdio.h>             /* for printf-debugging */
 #endif 
 #include <string.h>            /* for memset() */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>         /* SSE2 deinterleaving kernels */
+#define VAD_SSE2
+#endif
 #include "webrtc_vad.h" 
 #include "simplevad.h"
 
@@ -10,9 +14,7 @@
 /* max. supported sample rate in Hz */
 #define MAX_SAMPLERATE                  48000
 /* max. supported frame length in ms */
-#define MAX_FRAME_LENGTH                30
-/* max. possible buffer length */
-#define MAX_BUFFER_SIZE                 CALC_FRAME_SIZE(MAX_FRAME_LENGTH, MAX_SAMPLERATE)
+#define MAX_FRAME_LENGTH                VAD_FRAME_DURATION
 /* number of events per call */
 #define EVENT_BUFFER_SIZE               16
 /* number of unique event types */
@@ -30,50 +32,151 @@ static const char* event_names[3] = { "ERROR", "SILENCE", "VOICE" };
 /* VAD processing state and support structures */
 struct _vadstate_t
 {
-    /* ring buffer for full frames */
-    short        frame[MAX_BUFFER_SIZE];
+    /* ring buffer for full frames (located after the VAD instance) */
+    short*       frame;
+    /* capacity of the frame buffer in samples */
+    int          frame_capacity;
     /* length of a full frame of the given sample rate */
     int          frame_length;
     /* current frame offset (e.g. # of samples in buffer) */
     int          frame_offset;
     /* sample rate */
     int          sample_rate;
+    /* detection mode - re-applied on reset */
+    int          mode;
+    /* pre-gate thresholds - kept on reset */
+    vad_gate_t   gate;
+    /* 1 = pre-gate enabled */
+    int          gate_enabled;
+    /* number of frames classified by the pre-gate */
+    size_t       gate_skipped;
+    /* number of frames processed */
+    size_t       gate_frames;
     /* handle of the VAD implementation */
     VadInst*     vad;
 };
 
-/* Sample iterator */
+/* Pool of VAD states in a single slab */
+struct _vadpool_t
+{
+    /* number of slots */
+    size_t       count;
+    /* size of a single slot in bytes (multiple of the cache line size) */
+    size_t       slot_size;
+    /* number of slots on the free list */
+    size_t       available;
+    /* sample rate the slots are sized for */
+    int          sample_rate;
+    /* first slot (cache line aligned) */
+    char*        slots;
+    /* stack of free slot indices */
+    size_t*      free_list;
+    /* 1 for each acquired slot */
+    unsigned char* in_use;
+};
+
+/* Multi-channel VAD state - followed by one VAD state per channel */
+struct _vadmulti_t
+{
+    /* number of channels */
+    int          channels;
+    /* per-channel VAD states (cache line aligned) */
+    vad_t        channel[VAD_MAX_CHANNELS];
+    /* per-channel frame buffers */
+    short*       frames[VAD_MAX_CHANNELS];
+};
+
+/* Checkpoint header - followed by the VAD instance and the buffered samples */
+typedef struct _vad_checkpoint_t
+{
+    unsigned int magic;
+    unsigned int version;
+    /* size of the VAD instance in bytes */
+    unsigned int core_size;
+    int          sample_rate;
+    int          frame_length;
+    int          frame_offset;
+    int          mode;
+    /* pre-gate thresholds, state and statistics */
+    vad_gate_t   gate;
+    int          gate_enabled;
+    size_t       gate_skipped;
+    size_t       gate_frames;
+} vad_checkpoint_t;
+
+#define VAD_CHECKPOINT_MAGIC            0x53444156  /* 'VADS' */
+#define VAD_CHECKPOINT_VERSION          2
+
+/* Frame summary used by the pre-gate */
+typedef struct _vad_frame_summary
+{
+    int            min;            /* smallest sample */
+    int            max;            /* largest sample */
+    int            zero_crossings; /* number of sign changes */
+    double         energy;         /* sum of squared samples */
+} vad_frame_summary;
+
+/* Sample iterator - assembles frames from (interleaved) input */
 typedef struct _vad_sample_iterator
 {
-    short*         buf;    /* frame buffer */
-    const float*   ptr;    /* input samples */
-    size_t         ofs;    /* offset into frame buffer */
-    size_t         len;    /* number of input samples */
+    short**        bufs;   /* frame buffers, one per channel */
+    const char*    ptr;    /* input samples */
+    int            channels; /* number of interleaved channels */
+    int            format; /* input sample format */
+    size_t         ofs;    /* offset into frame buffers */
+    size_t         len;    /* number of input frames (samples per channel) */
     size_t         inc;    /* frame increment in samples */
 } vad_sample_iterator;
 
-static void vadFrameBegin(vad_sample_iterator* it, vad_t state, const float* samples, size_t num_samples);
+static void vadFrameBegin(vad_sample_iterator* it, vad_t state, short** bufs, int channels,
+                          const void* samples, vad_sample_format format, size_t num_frames);
 static int  vadFrameNext(vad_sample_iterator* it);
 static void vadFrameEnd(vad_t state, vad_sample_iterator* it);
+static void vadDeinterleave(short** bufs, size_t ofs, const char* src, int channels,
+                            int format, size_t count);
 static vad_event vadDecision(const int* histogram);
+static int  vadProcessFrame(vad_t state, int samplerate, const short* frame, size_t length);
+
+/* cache line size used for aligning pool slots */
+#define VAD_CACHE_LINE                  64
+/* round up to the next multiple of 'align' (must be a power of two) */
+#define ALIGN_UP(size, align)           (((size) + (align) - 1) & ~((size_t)(align) - 1))
 
-#define VAD_ADDR(mem) (((char*)(mem)) + sizeof(struct _vadstate_t))
+#define VAD_STATE_SIZE  ALIGN_UP(sizeof(struct _vadstate_t), sizeof(void*) * 2)
+#define VAD_ADDR(mem)   (((char*)(mem)) + VAD_STATE_SIZE)
 #define CLIP(value)   ((short)(value < -32768 ? 32768 : value > 32767 ? 32767 : value)) 
 
 static int vadInitState(vad_t state, int rate);
+static int vadCheckRate(vad_t state, int rate);
+static int vadValidRate(int rate);
+static size_t vadRequiredSize(int rate);
 
 vad_t vadAllocate(void* mem, size_t* memSize)
 {
-    int size = (int)(memSize ? memSize[0] : 0);
-    int required = WebRtcVad_CreateUser(NULL, size);
-    int result;
+    return vadAllocateRate(mem, memSize, 0);
+}
 
-    required += sizeof(struct _vadstate_t);
+vad_t vadAllocateRate(void* mem, size_t* memSize, int samplerate)
+{
+    size_t size = memSize ? memSize[0] : 0;
+    size_t required;
+    int result;
 
 #if defined(VAD_DEBUG)
-    printf("[native] vadAllocate mem=%p size=%d\n", mem, memSize ? (int)memSize[0] : -1);
+    printf("[native] vadAllocate mem=%p size=%d rate=%d\n", mem, memSize ? (int)memSize[0] : -1, samplerate);
 #endif
 
+    if (samplerate && !vadValidRate(samplerate))
+    {
+        if (memSize)
+        {
+            memSize[0] = 0;
+        }
+        return NULL;
+    }
+
+    required = vadRequiredSize(samplerate);
+
     if (size < required || !mem)
     {
         if (memSize)
@@ -83,12 +186,16 @@ vad_t vadAllocate(void* mem, size_t* memSize)
         return NULL;
     }
 
-    result = WebRtcVad_CreateUser(VAD_ADDR(mem), size);
+    result = WebRtcVad_CreateUser(VAD_ADDR(mem), size - VAD_STATE_SIZE);
     if (!result)
     {
         vad_t state = (vad_t)mem;
+        size_t vad_size = (size_t)WebRtcVad_CreateUser(NULL, 0);
         state->sample_rate = 0; 
+        state->mode = VAD_MODE_NORMAL;
         state->vad = (VadInst*)VAD_ADDR(mem);
+        state->frame = (short*)(VAD_ADDR(mem) + ALIGN_UP(vad_size, sizeof(void*) * 2));
+        state->frame_capacity = CALC_FRAME_SIZE(MAX_FRAME_LENGTH, samplerate ? samplerate : MAX_SAMPLERATE);
 
 #if defined(VAD_DEBUG)
         printf("[native] vadAllocate OK\n");
@@ -98,7 +205,7 @@ vad_t vadAllocate(void* mem, size_t* memSize)
 
     if (memSize)
     {
-        memSize[0] = result > 0 ? result + sizeof(struct _vadstate_t) : 0;
+        memSize[0] = result > 0 ? required : 0;
     }
 
 #if defined(VAD_DEBUG)
@@ -112,6 +219,13 @@ int vadInit(vad_t state)
 {
     int result = WebRtcVad_Init(state->vad);
 
+    state->sample_rate = 0;
+    state->frame_offset = 0;
+    state->mode = VAD_MODE_NORMAL;
+    state->gate_enabled = 0;
+    state->gate_skipped = 0;
+    state->gate_frames = 0;
+
 #if defined(VAD_DEBUG)
     printf("[native] vadInit res=%d\n", result);
 #endif
@@ -123,6 +237,11 @@ int vadSetMode(vad_t state, vad_mode mode)
 {
     int result = WebRtcVad_set_mode(state->vad, mode);
 
+    if (!result)
+    {
+        state->mode = mode;
+    }
+
 #if defined(VAD_DEBUG)
     printf("[native] vadSetMode mode=%d res=%d\n", mode, result);
 #endif
@@ -130,19 +249,452 @@ int vadSetMode(vad_t state, vad_mode mode)
     return result;
 }
 
+int vadReset(vad_t state)
+{
+    int mode = state->mode;
+    int gate_enabled = state->gate_enabled;
+    vad_gate_t gate = state->gate;
+    int result = vadInit(state);
+
+    if (!result)
+    {
+        result = vadSetMode(state, (vad_mode)mode);
+        state->gate = gate;
+        state->gate_enabled = gate_enabled;
+    }
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadReset res=%d\n", result);
+#endif
+
+    return result;
+}
+
+int vadSetGate(vad_t state, const vad_gate_t* gate)
+{
+    if (gate)
+    {
+        state->gate = *gate;
+        state->gate_enabled = gate->peak >= 0 || gate->energy >= 0 || gate->dc_range >= 0;
+    }
+    else
+    {
+        state->gate_enabled = 0;
+    }
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadSetGate enabled=%d\n", state->gate_enabled);
+#endif
+
+    return 0;
+}
+
+int vadGetGateStats(vad_t state, size_t* skipped, size_t* frames)
+{
+    if (skipped)
+    {
+        skipped[0] = state->gate_skipped;
+    }
+    if (frames)
+    {
+        frames[0] = state->gate_frames;
+    }
+
+    return 0;
+}
+
+int vadSaveState(vad_t state, void* mem, size_t* memSize)
+{
+    vad_checkpoint_t header;
+    size_t core_size = (size_t)WebRtcVad_CreateUser(NULL, 0);
+    size_t samples = state->sample_rate ? (size_t)state->frame_offset : 0;
+    size_t required = sizeof header + core_size + samples * sizeof(short);
+    char* out = (char*)mem;
+
+    if (!memSize || memSize[0] < required || !mem)
+    {
+        if (memSize)
+        {
+            memSize[0] = required;
+        }
+        return -1;
+    }
+
+    memset(&header, 0, sizeof header);
+    header.magic = VAD_CHECKPOINT_MAGIC;
+    header.version = VAD_CHECKPOINT_VERSION;
+    header.core_size = (unsigned int)core_size;
+    header.sample_rate = state->sample_rate;
+    header.frame_length = state->sample_rate ? state->frame_length : 0;
+    header.frame_offset = (int)samples;
+    header.mode = state->mode;
+    header.gate = state->gate;
+    header.gate_enabled = state->gate_enabled;
+    header.gate_skipped = state->gate_skipped;
+    header.gate_frames = state->gate_frames;
+
+    memcpy(out, &header, sizeof header);
+    memcpy(out + sizeof header, state->vad, core_size);
+    memcpy(out + sizeof header + core_size, state->frame, samples * sizeof(short));
+
+    memSize[0] = required;
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadSaveState size=%d\n", (int)required);
+#endif
+
+    return 0;
+}
+
+int vadLoadState(vad_t state, const void* mem, size_t memSize)
+{
+    vad_checkpoint_t header;
+    size_t core_size = (size_t)WebRtcVad_CreateUser(NULL, 0);
+    const char* in = (const char*)mem;
+
+    if (!mem || memSize < sizeof header)
+    {
+        return -1;
+    }
+
+    memcpy(&header, in, sizeof header);
+
+    if (header.magic != VAD_CHECKPOINT_MAGIC || header.version != VAD_CHECKPOINT_VERSION ||
+        header.core_size != core_size ||
+        header.mode < VAD_MODE_NORMAL || header.mode > VAD_MODE_VERY_AGGRESSIVE)
+    {
+        return -1;
+    }
+
+    if (header.gate_enabled < 0 || header.gate_enabled > 1 ||
+        (header.gate_enabled && header.gate.peak < 0 && header.gate.energy < 0 && header.gate.dc_range < 0) ||
+        header.gate_skipped > header.gate_frames)
+    {
+        return -1;
+    }
+
+    if (header.sample_rate &&
+        (!vadValidRate(header.sample_rate) ||
+         header.frame_length != CALC_FRAME_SIZE(MAX_FRAME_LENGTH, header.sample_rate) ||
+         header.frame_length > state->frame_capacity ||
+         header.frame_offset < 0 || header.frame_offset >= header.frame_length))
+    {
+        return -1;
+    }
+
+    if (!header.sample_rate && header.frame_offset != 0)
+    {
+        return -1;
+    }
+
+    if (memSize < sizeof header + core_size + header.frame_offset * sizeof(short))
+    {
+        return -1;
+    }
+
+    memcpy(state->vad, in + sizeof header, core_size);
+    memcpy(state->frame, in + sizeof header + core_size, header.frame_offset * sizeof(short));
+    state->sample_rate = header.sample_rate;
+    state->frame_length = header.frame_length;
+    state->frame_offset = header.frame_offset;
+    state->mode = header.mode;
+    state->gate = header.gate;
+    state->gate_enabled = header.gate_enabled;
+    state->gate_skipped = header.gate_skipped;
+    state->gate_frames = header.gate_frames;
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadLoadState rate=%d offset=%d\n", header.sample_rate, header.frame_offset);
+#endif
+
+    return 0;
+}
+
+vad_pool_t vadPoolAllocate(void* mem, size_t* memSize, size_t count, int samplerate)
+{
+    size_t size = memSize ? memSize[0] : 0;
+    size_t slot_size, header_size, required, i;
+    vad_pool_t pool;
+
+    if (!count || !vadValidRate(samplerate))
+    {
+        if (memSize)
+        {
+            memSize[0] = 0;
+        }
+        return NULL;
+    }
+
+    slot_size = ALIGN_UP(vadRequiredSize(samplerate), VAD_CACHE_LINE);
+    header_size = sizeof(struct _vadpool_t) + count * (sizeof(size_t) + sizeof(unsigned char));
+    /* reserve an extra cache line for aligning the first slot */
+    required = header_size + VAD_CACHE_LINE + count * slot_size;
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadPoolAllocate mem=%p size=%d count=%d rate=%d\n", mem, (int)size, (int)count, samplerate);
+#endif
+
+    if (size < required || !mem)
+    {
+        if (memSize)
+        {
+            memSize[0] = required;
+        }
+        return NULL;
+    }
+
+    pool = (vad_pool_t)mem;
+    pool->count = count;
+    pool->slot_size = slot_size;
+    pool->available = count;
+    pool->sample_rate = samplerate;
+    pool->free_list = (size_t*)((char*)mem + sizeof(struct _vadpool_t));
+    pool->in_use = (unsigned char*)(pool->free_list + count);
+    pool->slots = (char*)ALIGN_UP((size_t)((char*)mem + header_size), VAD_CACHE_LINE);
+
+    for (i = 0; i < count; ++i)
+    {
+        size_t slot_mem_size = slot_size;
+        vad_t state = vadAllocateRate(pool->slots + i * slot_size, &slot_mem_size, samplerate);
+
+        if (!state || vadInit(state))
+        {
+            if (memSize)
+            {
+                memSize[0] = 0;
+            }
+            return NULL;
+        }
+
+        /* hand out the lowest slots first */
+        pool->free_list[i] = count - 1 - i;
+        pool->in_use[i] = 0;
+    }
+
+    return pool;
+}
+
+vad_t vadPoolAcquire(vad_pool_t pool)
+{
+    vad_t state;
+    size_t slot;
+
+    if (!pool->available)
+    {
+        return NULL;
+    }
+
+    slot = pool->free_list[--pool->available];
+    state = (vad_t)(pool->slots + slot * pool->slot_size);
+
+    /* released slots keep their history - start over with default settings */
+    if (vadInit(state))
+    {
+        pool->free_list[pool->available++] = slot;
+        return NULL;
+    }
+
+    pool->in_use[slot] = 1;
+    return state;
+}
+
+int vadPoolRelease(vad_pool_t pool, vad_t state)
+{
+    size_t offset = (size_t)((char*)state - pool->slots);
+    size_t slot = offset / pool->slot_size;
+
+    /* only acquired slots can be released (rejects double releases) */
+    if ((char*)state < pool->slots || offset % pool->slot_size ||
+        slot >= pool->count || !pool->in_use[slot])
+    {
+        return -1;
+    }
+
+    pool->in_use[slot] = 0;
+    pool->free_list[pool->available++] = slot;
+    return 0;
+}
+
+size_t vadPoolSlotSize(vad_pool_t pool)
+{
+    return pool->slot_size;
+}
+
+vad_multi_t vadMultiAllocate(void* mem, size_t* memSize, int channels, int samplerate)
+{
+    size_t size = memSize ? memSize[0] : 0;
+    size_t slot_size, header_size, required;
+    vad_multi_t state;
+    int i;
+
+    if (channels < 1 || channels > VAD_MAX_CHANNELS || (samplerate && !vadValidRate(samplerate)))
+    {
+        if (memSize)
+        {
+            memSize[0] = 0;
+        }
+        return NULL;
+    }
+
+    slot_size = ALIGN_UP(vadRequiredSize(samplerate), VAD_CACHE_LINE);
+    header_size = sizeof(struct _vadmulti_t);
+    /* reserve an extra cache line for aligning the first channel */
+    required = header_size + VAD_CACHE_LINE + channels * slot_size;
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadMultiAllocate mem=%p size=%d channels=%d rate=%d\n", mem, (int)size, channels, samplerate);
+#endif
+
+    if (size < required || !mem)
+    {
+        if (memSize)
+        {
+            memSize[0] = required;
+        }
+        return NULL;
+    }
+
+    state = (vad_multi_t)mem;
+    state->channels = channels;
+
+    for (i = 0; i < channels; ++i)
+    {
+        size_t slot_mem_size = slot_size;
+        char* slot = (char*)ALIGN_UP((size_t)((char*)mem + header_size), VAD_CACHE_LINE) + i * slot_size;
+        vad_t channel = vadAllocateRate(slot, &slot_mem_size, samplerate);
+
+        if (!channel || vadInit(channel))
+        {
+            if (memSize)
+            {
+                memSize[0] = 0;
+            }
+            return NULL;
+        }
+
+        state->channel[i] = channel;
+        state->frames[i] = channel->frame;
+    }
+
+    return state;
+}
+
+int vadMultiSetMode(vad_multi_t state, vad_mode mode)
+{
+    int i, result = 0;
+
+    for (i = 0; i < state->channels && !result; ++i)
+    {
+        result = vadSetMode(state->channel[i], mode);
+    }
+
+    return result;
+}
+
+int vadMultiReset(vad_multi_t state)
+{
+    int i, result = 0;
+
+    for (i = 0; i < state->channels && !result; ++i)
+    {
+        result = vadReset(state->channel[i]);
+    }
+
+    return result;
+}
+
+int vadMultiSetGate(vad_multi_t state, const vad_gate_t* gate)
+{
+    int i, result = 0;
+
+    for (i = 0; i < state->channels && !result; ++i)
+    {
+        result = vadSetGate(state->channel[i], gate);
+    }
+
+    return result;
+}
+
+int vadMultiGetGateStats(vad_multi_t state, size_t* skipped, size_t* frames)
+{
+    size_t total_skipped = 0, total_frames = 0;
+    int i;
+
+    for (i = 0; i < state->channels; ++i)
+    {
+        total_skipped += state->channel[i]->gate_skipped;
+        total_frames += state->channel[i]->gate_frames;
+    }
+
+    if (skipped)
+    {
+        skipped[0] = total_skipped;
+    }
+    if (frames)
+    {
+        frames[0] = total_frames;
+    }
+
+    return 0;
+}
+
+int vadMultiChannels(vad_multi_t state)
+{
+    return state->channels;
+}
+
+int vadProcessInterleaved(vad_multi_t state, int samplerate, const void* samples,
+                          vad_sample_format format, size_t num_frames, vad_event* events)
+{
+    int                 histogram[VAD_MAX_CHANNELS][EVENT_COUNT];
+    vad_sample_iterator it;
+    int                 i;
+
+    if (format != VAD_SAMPLE_FLOAT && format != VAD_SAMPLE_INT16) { return -1; }
+
+    /* all channels are fed in lockstep, so they share rate and frame offset */
+    for (i = 0; i < state->channels; ++i)
+    {
+        vad_t channel = state->channel[i];
+        if (vadCheckRate(channel, samplerate)) { return -1; }
+    }
+
+    memset(histogram, 0, sizeof histogram);
+
+    vadFrameBegin(&it, state->channel[0], state->frames, state->channels, samples, format, num_frames);
+    while (!vadFrameNext(&it)) {
+        for (i = 0; i < state->channels; ++i)
+        {
+            int event = vadProcessFrame(state->channel[i], samplerate, it.bufs[i], it.inc);
+            ++histogram[i][EVENT_OFFSET(event)];
+        }
+    }
+
+    for (i = 0; i < state->channels; ++i)
+    {
+        vadFrameEnd(state->channel[i], &it);
+        events[i] = vadDecision(histogram[i]);
+    }
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadProcessInterleaved channels=%d frames=%d\n", state->channels, (int)num_frames);
+#endif
+
+    return 0;
+}
+
 vad_event vadProcessAudio(vad_t state, int samplerate, const float* samples, size_t num_samples)
 {
     int                 histogram[EVENT_COUNT];
     vad_sample_iterator it;
 
-    if (!state->sample_rate && vadInitState(state, samplerate)) { return VAD_EVENT_ERROR; }
-    else if (state->sample_rate != samplerate) { return VAD_EVENT_ERROR; } /* variable sample rate is not supported */
+    if (vadCheckRate(state, samplerate)) { return VAD_EVENT_ERROR; }
 
     memset(histogram, 0, sizeof histogram);
 
-    vadFrameBegin(&it, state, samples, num_samples);
+    vadFrameBegin(&it, state, &state->frame, 1, samples, VAD_SAMPLE_FLOAT, num_samples);
     while (!vadFrameNext(&it)) {
-        int event = WebRtcVad_Process(state->vad, samplerate, it.buf, it.inc);
+        int event = vadProcessFrame(state, samplerate, it.bufs[0], it.inc);
 #if defined(VAD_DEBUG)
         printf("[native] vadProcessAudio event=%s\n", NAME(event+1));
 #endif
@@ -153,42 +705,232 @@ vad_event vadProcessAudio(vad_t state, int samplerate, const float* samples, siz
     return vadDecision(histogram);
 }
 
+int vadProcessFrames(vad_t state, int samplerate, const float* samples, size_t num_samples,
+                     vad_event* events, size_t max_events)
+{
+    vad_sample_iterator it;
+    int                 count = 0;
+
+    if (vadCheckRate(state, samplerate)) { return -1; }
+
+    if (vadMaxFrames(samplerate, num_samples) > max_events) { return -1; }
+
+    vadFrameBegin(&it, state, &state->frame, 1, samples, VAD_SAMPLE_FLOAT, num_samples);
+    while (!vadFrameNext(&it))
+    {
+        int event = vadProcessFrame(state, samplerate, it.bufs[0], it.inc);
+        events[count++] = event < 0 ? VAD_EVENT_ERROR : event ? VAD_EVENT_VOICE : VAD_EVENT_SILENCE;
+    }
+    vadFrameEnd(state, &it);
+
+#if defined(VAD_DEBUG)
+    printf("[native] vadProcessFrames samples=%d frames=%d\n", (int)num_samples, count);
+#endif
+
+    return count;
+}
+
+size_t vadMaxFrames(int samplerate, size_t num_samples)
+{
+    size_t frame_length;
+
+    if (!vadValidRate(samplerate)) { return 0; }
+
+    /* up to one frame may already be partially buffered */
+    frame_length = CALC_FRAME_SIZE(MAX_FRAME_LENGTH, samplerate);
+    return num_samples / frame_length + 1;
+}
+
 static int vadInitState(vad_t state, int rate)
 {
+    int frame_length = CALC_FRAME_SIZE(MAX_FRAME_LENGTH, rate);
+
+    /* leave the state untouched, so the rate is rejected again on the next call */
+    if (!vadValidRate(rate) || frame_length > state->frame_capacity) { return 1; }
+
     state->sample_rate = rate;
-    state->frame_length = CALC_FRAME_SIZE(MAX_FRAME_LENGTH, rate);
+    state->frame_length = frame_length;
     state->frame_offset = 0;
-    return !(rate == 8000 || rate == 16000 || rate == 32000 || rate == 48000);
+    return 0;
+}
+
+static int vadCheckRate(vad_t state, int rate)
+{
+    if (!state->sample_rate && vadInitState(state, rate)) { return 1; }
+
+    /* variable sample rate is not supported */
+    return state->sample_rate != rate || state->frame_length > state->frame_capacity;
+}
+
+static int vadValidRate(int rate)
+{
+    return rate == 8000 || rate == 16000 || rate == 32000 || rate == 48000;
+}
+
+/* memory required for a state that supports the given rate (0: any rate) */
+static size_t vadRequiredSize(int rate)
+{
+    size_t vad_size = (size_t)WebRtcVad_CreateUser(NULL, 0);
+    size_t frame_size = CALC_FRAME_SIZE(MAX_FRAME_LENGTH, rate ? rate : MAX_SAMPLERATE) * sizeof(short);
+
+    return VAD_STATE_SIZE + ALIGN_UP(vad_size, sizeof(void*) * 2) + frame_size;
 }
 
-static void vadFrameBegin(vad_sample_iterator* it, vad_t state, const float* samples, size_t num_samples)
+static void vadFrameBegin(vad_sample_iterator* it, vad_t state, short** bufs, int channels,
+                          const void* samples, vad_sample_format format, size_t num_frames)
 {
-    it->buf = state->frame;
+    it->bufs = bufs;
+    it->channels = channels;
+    it->format = format;
     it->inc = state->frame_length;
-    it->len = num_samples;
-    it->ptr = samples;
+    it->len = num_frames;
+    it->ptr = (const char*)samples;
     it->ofs = state->frame_offset;
 }
 
 static int vadFrameNext(vad_sample_iterator* it)
 {
-    size_t i, fill;
+    size_t fill, sample_size;
+
+    /* the previous call completed a frame - start the next one */
+    if (it->ofs >= it->inc) { it->ofs = 0; }
+
+    if (it->len == 0) { return 1; }
+
+    fill = it->inc - it->ofs;
+    if (fill > it->len) { fill = it->len; }
+
+    vadDeinterleave(it->bufs, it->ofs, it->ptr, it->channels, it->format, fill);
+
+    sample_size = it->format == VAD_SAMPLE_INT16 ? sizeof(short) : sizeof(float);
+    it->ptr += fill * it->channels * sample_size;
+    it->ofs += fill;
+    it->len -= fill;
+
+    return it->ofs < it->inc;
+}
+
+/* convert 'count' float samples read with the given stride */
+static void vadConvertFloat(short* dst, const float* src, size_t stride, size_t count)
+{
+    size_t i = 0;
 
-    if (it->ofs >= it->inc)
+#if defined(VAD_SSE2)
+    if (stride == 1)
     {
-        it->ofs = 0;
-        return 0;
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+            __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+        }
     }
+#endif
 
-    if (it->len == 0) { return 1; }
+    for (; i < count; ++i)
+    {
+        int sample = src[i * stride] * 32768;
+        dst[i] = CLIP(sample);
+    }
+}
+
+/* copy 'count' 16bit samples read with the given stride */
+static void vadCopyShort(short* dst, const short* src, size_t stride, size_t count)
+{
+    size_t i;
 
-    for (i = 0, fill = it->inc - it->ofs; i < fill && it->len > 0; ++i, --it->len)
+    if (stride == 1)
     {
-        int sample = *it->ptr++ * 32768;
-        it->buf[it->ofs++] = CLIP(sample);
+        memcpy(dst, src, count * sizeof(short));
+        return;
     }
 
-    return it->ofs < it->inc;
+    for (i = 0; i < count; ++i)
+    {
+        dst[i] = src[i * stride];
+    }
+}
+
+#if defined(VAD_SSE2)
+/* split 'count' stereo float frames into two channels (8 frames per step) */
+static size_t vadDeinterleaveFloat2(short* left, short* right, const float* src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        __m128 c = _mm_loadu_ps(src + 2 * i + 8);
+        __m128 d = _mm_loadu_ps(src + 2 * i + 12);
+        __m128i l0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), scale));
+        __m128i l1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_shuffle_ps(c, d, _MM_SHUFFLE(2, 0, 2, 0)), scale));
+        __m128i r0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), scale));
+        __m128i r1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_shuffle_ps(c, d, _MM_SHUFFLE(3, 1, 3, 1)), scale));
+        _mm_storeu_si128((__m128i*)(left + i), _mm_packs_epi32(l0, l1));
+        _mm_storeu_si128((__m128i*)(right + i), _mm_packs_epi32(r0, r1));
+    }
+
+    return i;
+}
+
+/* split 'count' stereo 16bit frames into two channels (8 frames per step) */
+static size_t vadDeinterleaveShort2(short* left, short* right, const short* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 2 * i + 8));
+        __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                    _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+        _mm_storeu_si128((__m128i*)(left + i), l);
+        _mm_storeu_si128((__m128i*)(right + i), r);
+    }
+
+    return i;
+}
+#endif
+
+/* convert 'count' interleaved frames into the frame buffers starting at 'ofs' */
+static void vadDeinterleave(short** bufs, size_t ofs, const char* src, int channels,
+                            int format, size_t count)
+{
+    size_t done = 0;
+    int ch;
+
+    if (format == VAD_SAMPLE_INT16)
+    {
+        const short* in = (const short*)src;
+#if defined(VAD_SSE2)
+        if (channels == 2)
+        {
+            done = vadDeinterleaveShort2(bufs[0] + ofs, bufs[1] + ofs, in, count);
+        }
+#endif
+        for (ch = 0; ch < channels; ++ch)
+        {
+            vadCopyShort(bufs[ch] + ofs + done, in + done * channels + ch, channels, count - done);
+        }
+    }
+    else
+    {
+        const float* in = (const float*)src;
+#if defined(VAD_SSE2)
+        if (channels == 2)
+        {
+            done = vadDeinterleaveFloat2(bufs[0] + ofs, bufs[1] + ofs, in, count);
+        }
+#endif
+        for (ch = 0; ch < channels; ++ch)
+        {
+            vadConvertFloat(bufs[ch] + ofs + done, in + done * channels + ch, channels, count - done);
+        }
+    }
 }
 
 static void vadFrameEnd(vad_t state, vad_sample_iterator* it)
@@ -199,6 +941,120 @@ static void vadFrameEnd(vad_t state, vad_sample_iterator* it)
     state->frame_offset = it->ofs;
 }
 
+/* compute energy, range and zero crossings of a frame */
+static void vadFrameSummary(const short* frame, size_t length, vad_frame_summary* summary)
+{
+    size_t i = 0;
+    int min = 0, max = 0, zero_crossings = 0;
+    double energy = 0;
+
+    if (length == 0)
+    {
+        memset(summary, 0, sizeof *summary);
+        return;
+    }
+
+    min = max = frame[0];
+
+#if defined(VAD_SSE2)
+    if (length >= 9)
+    {
+        __m128i vmin = _mm_set1_epi16(frame[0]);
+        __m128i vmax = vmin;
+        __m128i vzc = _mm_setzero_si128();
+        __m128i vsum = _mm_setzero_si128();
+        const __m128i zero = _mm_setzero_si128();
+        short lanes[8];
+        long long sums[2];
+        int k;
+
+        /* start at 1 so each sample can be compared with its predecessor */
+        for (i = 1; i + 8 <= length; i += 8)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(frame + i));
+            __m128i prev = _mm_loadu_si128((const __m128i*)(frame + i - 1));
+            /* pairwise sums of squares are < 2^31 + 1 - accumulate as unsigned 64bit */
+            __m128i sq = _mm_madd_epi16(x, x);
+
+            vmin = _mm_min_epi16(vmin, x);
+            vmax = _mm_max_epi16(vmax, x);
+            vzc = _mm_sub_epi16(vzc, _mm_srai_epi16(_mm_xor_si128(x, prev), 15));
+            vsum = _mm_add_epi64(vsum, _mm_unpacklo_epi32(sq, zero));
+            vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi32(sq, zero));
+        }
+
+        _mm_storeu_si128((__m128i*)lanes, vmin);
+        for (k = 0; k < 8; ++k) if (lanes[k] < min) min = lanes[k];
+        _mm_storeu_si128((__m128i*)lanes, vmax);
+        for (k = 0; k < 8; ++k) if (lanes[k] > max) max = lanes[k];
+        _mm_storeu_si128((__m128i*)lanes, vzc);
+        for (k = 0; k < 8; ++k) zero_crossings += (unsigned short)lanes[k];
+        _mm_storeu_si128((__m128i*)sums, vsum);
+        energy = (double)sums[0] + (double)sums[1];
+        /* the first sample isn't part of the vector loop */
+        energy += (double)frame[0] * frame[0];
+    }
+    else
+#endif
+    {
+        energy = (double)frame[0] * frame[0];
+        i = 1;
+    }
+
+    for (; i < length; ++i)
+    {
+        int sample = frame[i];
+        if (sample < min) min = sample;
+        if (sample > max) max = sample;
+        zero_crossings += (sample ^ frame[i - 1]) < 0;
+        energy += (double)sample * sample;
+    }
+
+    summary->min = min;
+    summary->max = max;
+    summary->zero_crossings = zero_crossings;
+    summary->energy = energy;
+}
+
+/* 1 if the pre-gate classifies the frame as silence */
+static int vadGateSilent(const vad_gate_t* gate, const short* frame, size_t length)
+{
+    vad_frame_summary summary;
+    int peak;
+
+    vadFrameSummary(frame, length, &summary);
+    peak = summary.max > -summary.min ? summary.max : -summary.min;
+
+    if (gate->peak >= 0 && peak <= gate->peak)
+        return 1;                      /* digital silence */
+    if (gate->energy >= 0 && summary.energy <= (double)gate->energy * length)
+        return 1;                      /* low-level noise */
+    if (gate->dc_range >= 0 && summary.zero_crossings == 0 &&
+        summary.max - summary.min <= gate->dc_range)
+        return 1;                      /* DC offset or clipped */
+
+    return 0;
+}
+
+/* run a single frame through the pre-gate and the VAD core */
+static int vadProcessFrame(vad_t state, int samplerate, const short* frame, size_t length)
+{
+    if (!state->gate_enabled)
+    {
+        return WebRtcVad_Process(state->vad, samplerate, frame, length);
+    }
+
+    ++state->gate_frames;
+
+    if (vadGateSilent(&state->gate, frame, length))
+    {
+        ++state->gate_skipped;
+        return WebRtcVad_ProcessSilence(state->vad);
+    }
+
+    return WebRtcVad_Process(state->vad, samplerate, frame, length);
+}
+
 static vad_event vadDecision(const int* histogram)
 {
     int i, sum, maj;
@@ -208,7 +1064,7 @@ static vad_event vadDecision(const int* histogram)
     if (sum == 0)
         return VAD_EVENT_SILENCE;      /* not enough data - default to silence */
 
-    maj = (sum * 80) / 100;            /* calculate 80% of grand total */
+    maj = (sum * 80 + 99) / 100;       /* calculate 80% of grand total (rounded up) */
 
     if (SELECT_EVENT(VAD_EVENT_ERROR, histogram) > 0)
         return VAD_EVENT_ERROR;        /* something went wrong along the way */
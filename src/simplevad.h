@@ -10,6 +10,18 @@ extern "C" {
 /* Opaque VAD system state */
 typedef struct _vadstate_t* vad_t; 
 
+/* Opaque pool of VAD system states */
+typedef struct _vadpool_t* vad_pool_t;
+
+/* Opaque multi-channel VAD system state */
+typedef struct _vadmulti_t* vad_multi_t;
+
+/* max. number of channels of a multi-channel VAD */
+#define VAD_MAX_CHANNELS 32
+
+/* duration of an analysed audio frame in ms */
+#define VAD_FRAME_DURATION 30
+
 /* VAD event types */
 typedef enum _vad_event
 {
@@ -23,6 +35,28 @@ typedef enum _vad_event
     VAD_EVENT_NOISE = 2
 } vad_event;
 
+/* Sample formats of interleaved input */
+typedef enum _vad_sample_format
+{
+    /* normalised 32bit float (-1..+1) */
+    VAD_SAMPLE_FLOAT = 0,
+    /* signed 16bit integer */
+    VAD_SAMPLE_INT16 = 1
+} vad_sample_format;
+
+/* Pre-gate thresholds - frames matching any enabled criterion are
+   classified as silence without running the VAD core. Thresholds
+   refer to 16bit samples, -1 disables a criterion. */
+typedef struct _vad_gate_t
+{
+    /* max. absolute amplitude of a silent frame */
+    int peak;
+    /* max. mean energy (mean of the squared samples) of a silent frame */
+    int energy;
+    /* max. peak-to-peak range of a DC (or clipped) frame without zero crossings */
+    int dc_range;
+} vad_gate_t;
+
 /* VAD detection modes */
 typedef enum _vad_mode
 {
@@ -46,6 +80,21 @@ typedef enum _vad_mode
  */
 vad_t    vadAllocate(void* mem, size_t* memSize);
 
+/**
+ * Allocate the VAD system state for a single sample rate
+ * @param mem        Memory for the VAD state - can be NULL
+ * @param memSize    Size of the provided memory; will be set
+ *                   to the actual used/required memory in bytes
+ * @param samplerate Sample rate the state will be used with;
+ *                   0 to support any sample rate
+ * @returns Opaque system state, NULL, if no memory was provided,
+ *          the given memory size was too low or the rate is invalid
+ * @remarks
+ * The frame buffer is sized for the given rate, so lower rates
+ * require less memory.
+ */
+vad_t    vadAllocateRate(void* mem, size_t* memSize, int samplerate);
+
 /**
  * Initialise the VAD system
  * @param    state        VAD system state
@@ -61,6 +110,106 @@ int      vadInit(vad_t state);
  */
 int      vadSetMode(vad_t state, vad_mode mode);
 
+/**
+ * Reset the VAD system for a new stream
+ * @param    state        VAD system state
+ * @returns 0 on successs, <0 on error
+ * @remarks
+ * Works in place and keeps the detection mode.
+ */
+int      vadReset(vad_t state);
+
+/**
+ * Configure the pre-gate
+ * @param    state        VAD system state
+ * @param    gate         Gate thresholds, NULL to disable the pre-gate
+ * @returns 0 on successs, <0 on error
+ * @remarks
+ * Gated frames are approximated as frames below the VAD's minimum energy:
+ * the speech and noise models are left unchanged, the hangover advances
+ * and filter states are cleared as if the filters had settled on silence
+ * (see WebRtcVad_ProcessSilence()). Decisions may therefore differ for
+ * low-level frames that follow gated frames. The gate is disabled by
+ * vadInit() and kept by vadReset().
+ */
+int      vadSetGate(vad_t state, const vad_gate_t* gate);
+
+/**
+ * Get pre-gate statistics since the last vadInit() or vadReset()
+ * @param    state        VAD system state
+ * @param    skipped      Receives the number of frames classified by the gate
+ * @param    frames       Receives the number of frames processed with the gate enabled
+ * @returns 0 on successs, <0 on error
+ * @remarks
+ * Each complete frame of VAD_FRAME_DURATION ms is counted once, e.g.
+ * one second of audio yields 33 frames.
+ */
+int      vadGetGateStats(vad_t state, size_t* skipped, size_t* frames);
+
+/**
+ * Save the VAD system state to a checkpoint
+ * @param    state        VAD system state
+ * @param    mem          Memory for the checkpoint - can be NULL
+ * @param    memSize      Size of the provided memory; will be set
+ *                        to the actual used/required memory in bytes
+ * @returns 0 on successs, <0 if no memory was provided or the given
+ *          memory size was too low
+ * @remarks
+ * The checkpoint is versioned and contains the model (GMM means and
+ * deviations), filter states, buffered samples and the pre-gate settings
+ * and statistics. It can be loaded on any host of the same architecture.
+ */
+int      vadSaveState(vad_t state, void* mem, size_t* memSize);
+
+/**
+ * Restore the VAD system state from a checkpoint
+ * @param    state        Allocated VAD system state
+ * @param    mem          Checkpoint written by vadSaveState()
+ * @param    memSize      Size of the checkpoint in bytes
+ * @returns 0 on successs, <0 if the checkpoint is invalid or
+ *          doesn't fit the state (see vadAllocateRate())
+ * @remarks
+ * Processing continues with bit-identical results.
+ */
+int      vadLoadState(vad_t state, const void* mem, size_t memSize);
+
+/**
+ * Allocate a pool of VAD system states in a single slab
+ * @param mem        Memory for the pool - can be NULL
+ * @param memSize    Size of the provided memory; will be set
+ *                   to the actual used/required memory in bytes
+ * @param count      Number of VAD states in the pool
+ * @param samplerate Sample rate of all states in the pool
+ * @returns Opaque pool, NULL, if no memory was provided,
+ *          the given memory size was too low or the arguments are invalid
+ * @remarks
+ * Each state occupies its own cache line aligned slot.
+ */
+vad_pool_t vadPoolAllocate(void* mem, size_t* memSize, size_t count, int samplerate);
+
+/**
+ * Take an initialised VAD system state from the pool
+ * @param    pool         VAD pool
+ * @returns VAD system state in default mode, NULL if the pool is exhausted
+ */
+vad_t    vadPoolAcquire(vad_pool_t pool);
+
+/**
+ * Return a VAD system state to the pool
+ * @param    pool         VAD pool
+ * @param    state        VAD system state as returned by vadPoolAcquire()
+ * @returns 0 on successs, <0 if the state doesn't belong to the pool
+ *          or isn't acquired
+ */
+int      vadPoolRelease(vad_pool_t pool, vad_t state);
+
+/**
+ * Get the size of a single pool slot
+ * @param    pool         VAD pool
+ * @returns Slot size in bytes
+ */
+size_t   vadPoolSlotSize(vad_pool_t pool);
+
 /**
  * Process audio samples
  * @param state         VAD system state as returned by vadInit()
@@ -72,6 +221,105 @@ int      vadSetMode(vad_t state, vad_mode mode);
  */
 vad_event  vadProcessAudio(vad_t state, int samplerate, const float* samples, size_t num_samples);
 
+/**
+ * Process audio samples and report a decision for each completed frame
+ * @param state         VAD system state as returned by vadInit()
+ * @param samplerate    Sample rate of the samples in Hz
+ * @param samples       Pointer to PCM samples that are to be processed
+ * @param num_samples   Total number of samples in the provided buffer
+ * @param events        Receives the event of each frame completed by the samples
+ * @param max_events    Capacity of 'events' - see vadMaxFrames()
+ * @returns Number of events written, <0 on error
+ * @remarks
+ * Samples of an incomplete frame are buffered and complete the frame
+ * on a subsequent call, so input can be split at arbitrary positions.
+ */
+int        vadProcessFrames(vad_t state, int samplerate, const float* samples, size_t num_samples,
+                            vad_event* events, size_t max_events);
+
+/**
+ * Get the maximum number of frames that can be completed by the given samples
+ * @param samplerate    Sample rate of the samples in Hz
+ * @param num_samples   Number of samples
+ * @returns Required capacity of the events passed to vadProcessFrames(),
+ *          0 if the sample rate is invalid
+ */
+size_t     vadMaxFrames(int samplerate, size_t num_samples);
+
+/**
+ * Allocate a multi-channel VAD system state
+ * @param mem        Memory for the state - can be NULL
+ * @param memSize    Size of the provided memory; will be set
+ *                   to the actual used/required memory in bytes
+ * @param channels   Number of channels (1..VAD_MAX_CHANNELS)
+ * @param samplerate Sample rate the state will be used with;
+ *                   0 to support any sample rate
+ * @returns Initialised state in default mode, NULL, if no memory was
+ *          provided, the given memory size was too low or the arguments
+ *          are invalid
+ * @remarks
+ * Each channel is analysed by a VAD instance of its own.
+ */
+vad_multi_t vadMultiAllocate(void* mem, size_t* memSize, int channels, int samplerate);
+
+/**
+ * Apply detection mode to all channels
+ * @param    state        Multi-channel VAD system state
+ * @param    mode         Detection mode
+ * @returns 0 on successs, <0 on error
+ */
+int      vadMultiSetMode(vad_multi_t state, vad_mode mode);
+
+/**
+ * Reset all channels for a new stream
+ * @param    state        Multi-channel VAD system state
+ * @returns 0 on successs, <0 on error
+ * @remarks
+ * Works in place and keeps the detection mode.
+ */
+int      vadMultiReset(vad_multi_t state);
+
+/**
+ * Configure the pre-gate of all channels (see vadSetGate())
+ * @param    state        Multi-channel VAD system state
+ * @param    gate         Gate thresholds, NULL to disable the pre-gate
+ * @returns 0 on successs, <0 on error
+ */
+int      vadMultiSetGate(vad_multi_t state, const vad_gate_t* gate);
+
+/**
+ * Get pre-gate statistics summed over all channels (see vadGetGateStats())
+ * @param    state        Multi-channel VAD system state
+ * @param    skipped      Receives the number of frames classified by the gate
+ * @param    frames       Receives the total number of frames processed
+ * @returns 0 on successs, <0 on error
+ */
+int      vadMultiGetGateStats(vad_multi_t state, size_t* skipped, size_t* frames);
+
+/**
+ * Get the number of channels
+ * @param    state        Multi-channel VAD system state
+ * @returns Number of channels
+ */
+int      vadMultiChannels(vad_multi_t state);
+
+/**
+ * Process interleaved audio samples
+ * @param state         Multi-channel VAD system state
+ * @param samplerate    Sample rate of the input in Hz
+ * @param samples       Pointer to interleaved PCM samples
+ * @param format        Sample format
+ * @param num_frames    Number of sample frames (samples per channel)
+ * @param events        Receives the event type of each channel
+ * @returns 0 on successs, <0 on error
+ * @remarks
+ * Channels are deinterleaved while frames are assembled. The event of
+ * each channel equals the result of vadProcessAudio() on the same
+ * channel's samples.
+ */
+int      vadProcessInterleaved(vad_multi_t state, int samplerate, const void* samples,
+                               vad_sample_format format, size_t num_frames, vad_event* events);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,728 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mpadec.h"
+#include "simplevad.h"
+
+/**
+ * Command-line batch analyser for MPEG audio files.
+ *
+ * Input files are memory mapped and fed to the decoder and the VAD on
+ * a fixed pool of worker threads, one file per task. Mapping avoids
+ * read buffers, but the decoder still copies each slice of input into
+ * its own buffer list.
+ * The voice segments of each file are written to stdout as a single
+ * JSON line, a summary is written to stderr.
+ *
+ * Usage: vad-batch [-j threads] [-m mode] [-w window] <file|directory>...
+ */
+
+using std::min;
+using std::string;
+using std::vector;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace batch
+{
+
+namespace
+{
+
+// max. number of samples per channel in a decoded frame
+static const int MP3_FRAME_SIZE = 1152;
+
+// number of mapped bytes passed to the decoder per call
+static const size_t INPUT_CHUNK_SIZE = 64 * 1024;
+
+// size of an ID3v1 tag at the end of a file
+static const size_t ID3V1_TAG_SIZE = 128;
+
+// duration of a single VAD frame in ms
+static const int VAD_FRAME_MS = 30;
+
+struct Options
+{
+    unsigned threads;
+    int mode;
+    int window;     // ms of audio per decision
+};
+
+// Analysis result of a single file
+struct Result
+{
+    string error;
+    int samplerate;         // sample rate of the input
+    int channels;
+    int vadRate;            // sample rate the VAD was run at
+    size_t samples;         // number of samples passed to the VAD
+    size_t undecoded;       // input bytes left in the decoder at the end
+    bool partial;           // audio was decoded, but decoding stopped early or left input unused
+    vector<size_t> segments;  // [start, end) pairs in VAD samples
+    double decodeMs;
+    double vadMs;
+    double totalMs;
+};
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() : data_(NULL), size_(0) { }
+    ~MappedFile()
+    {
+        if (data_)
+        {
+            munmap(data_, size_);
+        }
+    }
+
+    // returns an error message or NULL on success
+    const char* Open(const string& path)
+    {
+        struct stat st;
+        int fd = open(path.c_str(), O_RDONLY);
+
+        if (fd < 0)
+        {
+            return strerror(errno);
+        }
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return strerror(errno);
+        }
+        if (st.st_size == 0)
+        {
+            close(fd);
+            return "Empty file";
+        }
+
+        void* data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            return strerror(errno);
+        }
+
+        data_ = data;
+        size_ = static_cast<size_t>(st.st_size);
+        madvise(data_, size_, MADV_SEQUENTIAL);
+        return NULL;
+    }
+
+    unsigned char* Data() const { return static_cast<unsigned char*>(data_); }
+    size_t Size() const { return size_; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    void* data_;
+    size_t size_;
+};
+
+// Averaging (box filter) resampler for rates that the VAD doesn't support
+class Resampler
+{
+public:
+    void Init(int inRate, int outRate)
+    {
+        inRate_ = inRate;
+        outRate_ = outRate;
+        phase_ = 0;
+        sum_ = 0;
+        count_ = 0;
+    }
+
+    // append the resampled input to 'out'; returns the number of output samples
+    size_t Process(const float* in, size_t length, float* out)
+    {
+        size_t n = 0;
+
+        if (inRate_ == outRate_)
+        {
+            std::copy(in, in + length, out);
+            return length;
+        }
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            sum_ += in[i];
+            ++count_;
+            phase_ += outRate_;
+
+            if (phase_ >= inRate_)
+            {
+                phase_ -= inRate_;
+                out[n++] = sum_ / count_;
+                sum_ = 0;
+                count_ = 0;
+            }
+        }
+
+        return n;
+    }
+
+private:
+    int inRate_;
+    int outRate_;
+    int phase_;
+    float sum_;
+    int count_;
+};
+
+// VAD sample rate used for the given input rate
+int GetVADRate(int samplerate)
+{
+    switch (samplerate)
+    {
+        case 8000:
+        case 16000:
+        case 32000:
+        case 48000:
+            return samplerate;
+        default:
+            // 11.025, 22.05, 24 and 44.1kHz
+            return samplerate > 16000 ? 16000 : 8000;
+    }
+}
+
+// Per-thread decoder and VAD state, reused for all files of the thread
+class Worker
+{
+public:
+    explicit Worker(const Options& options) : options_(options)
+    {
+        size_t vadSize = 0;
+
+        hip_.resize(static_cast<size_t>(hip_decode_init(NULL)));
+        vadAllocate(NULL, &vadSize);
+        vad_.resize(vadSize);
+    }
+
+    void Analyse(const string& path, Result& result)
+    {
+        Clock::time_point start = Clock::now();
+        MappedFile file;
+        const char* error = file.Open(path);
+
+        result.samplerate = 0;
+        result.channels = 0;
+        result.vadRate = 0;
+        result.samples = 0;
+        result.undecoded = 0;
+        result.partial = false;
+        result.decodeMs = 0;
+        result.vadMs = 0;
+
+        if (error)
+        {
+            result.error = error;
+        }
+        else
+        {
+            hip_t hip = reinterpret_cast<hip_t>(&hip_[0]);
+            hip_decode_init(hip);
+            Decode(hip, file, result);
+            result.undecoded = hip_decode_buffered(hip);
+            // a file without any decoded audio has failed rather than being partial
+            result.partial = result.samples > 0 &&
+                             (!result.error.empty() ||
+                              (result.undecoded > 0 && !IsID3v1Tail(file, result.undecoded)));
+            hip_decode_exit(hip);
+        }
+
+        result.totalMs = ElapsedMs(start);
+    }
+
+private:
+    // feed the file in slices and drain the decoder until it makes no more progress
+    void Decode(hip_t hip, const MappedFile& file, Result& result)
+    {
+        size_t offset = 0;
+        bool voice = false;
+
+        while (offset < file.Size() && result.error.empty())
+        {
+            size_t length = min(INPUT_CHUNK_SIZE, file.Size() - offset);
+            size_t buffered = hip_decode_buffered(hip) + length;
+            Clock::time_point start = Clock::now();
+            int ret = hip_decode1_headers(hip, file.Data() + offset, length, left_, right_, &data_);
+
+            offset += length;
+            for (;;)
+            {
+                size_t remaining = hip_decode_buffered(hip);
+
+                if (ret > 0)
+                {
+                    result.decodeMs += ElapsedMs(start);
+                    if (!Analyse(ret, result, voice))
+                    {
+                        start = Clock::now();
+                        break;
+                    }
+                    start = Clock::now();
+                }
+                else if (ret < 0)
+                {
+                    result.error = "Decoder error";
+                    break;
+                }
+                else if (remaining == buffered)
+                {
+                    // neither output nor consumed input - more data is needed
+                    break;
+                }
+
+                buffered = remaining;
+                ret = hip_decode1_headers(hip, NULL, 0, left_, right_, &data_);
+            }
+
+            result.decodeMs += ElapsedMs(start);
+        }
+
+        if (!result.vadRate && result.error.empty())
+        {
+            result.error = "No audio frames found";
+        }
+        if (result.vadRate && blockFill_ > 0)
+        {
+            Flush(result, voice);
+        }
+        if (voice)
+        {
+            result.segments.push_back(result.samples);
+        }
+    }
+
+    // true if the undecoded input is just an ID3v1 tag at the end of the file
+    static bool IsID3v1Tail(const MappedFile& file, size_t undecoded)
+    {
+        return undecoded == ID3V1_TAG_SIZE && file.Size() >= ID3V1_TAG_SIZE &&
+               memcmp(file.Data() + file.Size() - ID3V1_TAG_SIZE, "TAG", 3) == 0;
+    }
+
+    // pass a decoded frame to the VAD
+    bool Analyse(int count, Result& result, bool& voice)
+    {
+        Clock::time_point start = Clock::now();
+
+        if (!result.vadRate)
+        {
+            if (!BeginAudio(result))
+            {
+                return false;
+            }
+        }
+        else if (data_.samplerate != result.samplerate)
+        {
+            result.error = "Variable sample rate is not supported";
+            return false;
+        }
+
+        // mix down to mono
+        float mono[MP3_FRAME_SIZE];
+        const float scale = data_.stereo > 1 ? 1.0f / 65536.0f : 1.0f / 32768.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            mono[i] = (data_.stereo > 1 ? left_[i] + right_[i] : left_[i]) * scale;
+        }
+
+        size_t pending = windowSize_;
+        size_t length = resampler_.Process(mono, static_cast<size_t>(count), &block_[0] + blockFill_);
+        blockFill_ += length;
+
+        while (blockFill_ >= pending)
+        {
+            vad_event event = vadProcessAudio(vad(), result.vadRate, &block_[0], pending);
+
+            if (event == VAD_EVENT_ERROR)
+            {
+                result.error = "VAD error";
+                return false;
+            }
+            if ((event == VAD_EVENT_VOICE) != voice)
+            {
+                voice = !voice;
+                result.segments.push_back(result.samples);
+            }
+
+            result.samples += pending;
+            blockFill_ -= pending;
+            std::copy(block_.begin() + pending, block_.begin() + pending + blockFill_, block_.begin());
+        }
+
+        result.vadMs += ElapsedMs(start);
+        return true;
+    }
+
+    // analyse the trailing partial window, zero-padded to the window size
+    void Flush(Result& result, bool& voice)
+    {
+        Clock::time_point start = Clock::now();
+
+        std::fill(block_.begin() + blockFill_, block_.begin() + windowSize_, 0.0f);
+        vad_event event = vadProcessAudio(vad(), result.vadRate, &block_[0], windowSize_);
+
+        if (event == VAD_EVENT_ERROR)
+        {
+            if (result.error.empty())
+            {
+                result.error = "VAD error";
+            }
+        }
+        else if ((event == VAD_EVENT_VOICE) != voice)
+        {
+            voice = !voice;
+            result.segments.push_back(result.samples);
+        }
+
+        // only the decoded samples count towards the duration
+        result.samples += blockFill_;
+        blockFill_ = 0;
+        result.vadMs += ElapsedMs(start);
+    }
+
+    bool BeginAudio(Result& result)
+    {
+        result.samplerate = data_.samplerate;
+        result.channels = data_.stereo;
+        result.vadRate = GetVADRate(data_.samplerate);
+
+        size_t memSize = vad_.size();
+        if (!vadAllocate(&vad_[0], &memSize) || vadInit(vad()) != 0 ||
+            vadSetMode(vad(), static_cast<vad_mode>(options_.mode)) != 0)
+        {
+            result.error = "Failed to initialise VAD";
+            return false;
+        }
+
+        resampler_.Init(result.samplerate, result.vadRate);
+
+        // a decision window plus the (resampled) output of a single frame
+        size_t window = static_cast<size_t>(result.vadRate / 1000 * options_.window);
+        windowSize_ = window;
+        block_.resize(window + MP3_FRAME_SIZE);
+        blockFill_ = 0;
+        return true;
+    }
+
+    vad_t vad() { return reinterpret_cast<vad_t>(&vad_[0]); }
+
+    const Options& options_;
+    vector<char> hip_;
+    vector<char> vad_;
+    size_t windowSize_;
+    vector<float> block_;
+    size_t blockFill_;
+    Resampler resampler_;
+    mp3data_struct data_;
+    short left_[MP3_FRAME_SIZE];
+    short right_[MP3_FRAME_SIZE];
+};
+
+void AppendJSONString(string& out, const string& value)
+{
+    out += '"';
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof escaped, "\\u%04x", c);
+                    out += escaped;
+                }
+                else
+                {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+void AppendNumber(string& out, const char* format, double value)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof buffer, format, value);
+    out += buffer;
+}
+
+// {"file":...,"rate":...,"channels":...,"duration":...,"segments":[[start,end],...],"time":{...}}
+string FormatResult(const string& path, const Result& result)
+{
+    string line = "{\"file\":";
+    AppendJSONString(line, path);
+
+    if (!result.error.empty())
+    {
+        line += ",\"error\":";
+        AppendJSONString(line, result.error);
+    }
+
+    // report what has been analysed, even if decoding stopped early
+    if (result.vadRate)
+    {
+        double rate = result.vadRate;
+
+        AppendNumber(line, ",\"rate\":%.0f", result.samplerate);
+        AppendNumber(line, ",\"channels\":%.0f", result.channels);
+        AppendNumber(line, ",\"duration\":%.3f", result.samples / rate);
+        line += ",\"segments\":[";
+        for (size_t i = 0; i + 1 < result.segments.size(); i += 2)
+        {
+            AppendNumber(line, i ? ",[%.3f" : "[%.3f", result.segments[i] / rate);
+            AppendNumber(line, ",%.3f]", result.segments[i + 1] / rate);
+        }
+        line += "]";
+    }
+
+    if (result.partial)
+    {
+        AppendNumber(line, ",\"partial\":true,\"undecoded\":%.0f", static_cast<double>(result.undecoded));
+    }
+
+    AppendNumber(line, ",\"time\":{\"decode\":%.3f", result.decodeMs);
+    AppendNumber(line, ",\"vad\":%.3f", result.vadMs);
+    AppendNumber(line, ",\"total\":%.3f}}\n", result.totalMs);
+    return line;
+}
+
+bool IsAudioFile(const string& name)
+{
+    static const char* const extensions[] = { ".mp3", ".mp2", ".mpa" };
+    size_t dot = name.rfind('.');
+
+    if (dot == string::npos)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof extensions / sizeof extensions[0]; ++i)
+    {
+        if (strcasecmp(name.c_str() + dot, extensions[i]) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// add the given file or all audio files found in the given directory tree
+void CollectFiles(const string& path, vector<string>& files, bool explicitPath)
+{
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        return;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+    {
+        if (explicitPath || (S_ISREG(st.st_mode) && IsAudioFile(path)))
+        {
+            files.push_back(path);
+        }
+        return;
+    }
+
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        return;
+    }
+
+    vector<string> entries;
+    while (struct dirent* entry = readdir(dir))
+    {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+            entries.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        CollectFiles(path + "/" + entries[i], files, false);
+    }
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "Usage: vad-batch [-j threads] [-m mode] [-w window] <file|directory>...\n"
+            "  -j threads  number of worker threads (default: number of CPUs)\n"
+            "  -m mode     VAD mode 0..3 (default: 0)\n"
+            "  -w window   ms of audio per decision, multiple of %d (default: %d)\n",
+            VAD_FRAME_MS, VAD_FRAME_MS);
+}
+
+bool ParseInt(const char* arg, int minValue, int maxValue, int& value)
+{
+    char* end = NULL;
+    long parsed = arg ? strtol(arg, &end, 10) : 0;
+
+    if (!arg || !*arg || *end || parsed < minValue || parsed > maxValue)
+    {
+        return false;
+    }
+
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+} // namespace
+
+int Run(int argc, char* argv[])
+{
+    Options options;
+    vector<string> files;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    options.mode = VAD_MODE_NORMAL;
+    options.window = VAD_FRAME_MS;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool valid = true;
+
+        if (strcmp(arg, "-j") == 0)
+        {
+            valid = ParseInt(i + 1 < argc ? argv[++i] : NULL, 1, 1024, threads);
+        }
+        else if (strcmp(arg, "-m") == 0)
+        {
+            valid = ParseInt(i + 1 < argc ? argv[++i] : NULL, VAD_MODE_NORMAL, VAD_MODE_VERY_AGGRESSIVE, options.mode);
+        }
+        else if (strcmp(arg, "-w") == 0)
+        {
+            valid = ParseInt(i + 1 < argc ? argv[++i] : NULL, VAD_FRAME_MS, 60000, options.window) &&
+                    options.window % VAD_FRAME_MS == 0;
+        }
+        else if (arg[0] == '-')
+        {
+            valid = false;
+        }
+        else
+        {
+            CollectFiles(arg, files, true);
+        }
+
+        if (!valid)
+        {
+            Usage();
+            return 2;
+        }
+    }
+
+    if (files.empty())
+    {
+        Usage();
+        return 2;
+    }
+
+    options.threads = static_cast<unsigned>(std::max(1, min(threads, static_cast<int>(files.size()))));
+
+    // the shared decoder tables must be built before decoders are created concurrently
+    hip_init_tables();
+
+    Clock::time_point start = Clock::now();
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> failed(0);
+    std::atomic<size_t> partial(0);
+    std::mutex outputLock;
+    double audioSeconds = 0;
+    vector<std::thread> pool;
+
+    for (unsigned t = 0; t < options.threads; ++t)
+    {
+        pool.push_back(std::thread([&]()
+        {
+            Worker worker(options);
+            Result result;
+            size_t index;
+
+            while ((index = next++) < files.size())
+            {
+                result.error.clear();
+                result.segments.clear();
+                worker.Analyse(files[index], result);
+
+                string line = FormatResult(files[index], result);
+                std::lock_guard<std::mutex> lock(outputLock);
+
+                if (result.vadRate)
+                {
+                    audioSeconds += static_cast<double>(result.samples) / result.vadRate;
+                }
+                if (result.partial)
+                {
+                    ++partial;
+                }
+                else if (!result.error.empty())
+                {
+                    ++failed;
+                }
+                fwrite(line.data(), 1, line.size(), stdout);
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < pool.size(); ++t)
+    {
+        pool[t].join();
+    }
+
+    double seconds = ElapsedMs(start) / 1000.0;
+    fflush(stdout);
+    fprintf(stderr, "%u files (%u failed, %u partial), %.1fs audio in %.2fs using %u threads (%.0fx realtime)\n",
+            static_cast<unsigned>(files.size()), static_cast<unsigned>(failed.load()),
+            static_cast<unsigned>(partial.load()),
+            audioSeconds, seconds, options.threads, seconds > 0 ? audioSeconds / seconds : 0.0);
+
+    return failed.load() == files.size() ? 1 : 0;
+}
+
+} // namespace batch
+
+int main(int argc, char* argv[])
+{
+    return batch::Run(argc, argv);
+}
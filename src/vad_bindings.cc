@@ -1,11 +1,13 @@
 #include <algorithm>
 #include <sstream>
+#include <vector>
 #include <nan.h>
 #include "simplevad.h"
 
 using std::min;
 using std::transform;
 using std::stringstream;
+using std::vector;
 
 // required due to name collisions between Nan and V8 - we need to choose what we want here
 using v8::Array;
@@ -68,6 +70,128 @@ private:
     vad_event    result;
 };
 
+// Async worker for multi-channel voice activity detection
+class InterleavedVADWorker : public AsyncWorker
+{
+public:
+    InterleavedVADWorker(Callback* callback, vad_multi_t vad, int rate, const void* samples,
+                         vad_sample_format format, size_t frames)
+        : AsyncWorker(callback), vad(vad), rate(rate), samples(samples), format(format),
+          frames(frames), result(0) {}
+
+    ~InterleavedVADWorker() {}
+
+    /**
+     *    Performs work in a separate thread.
+     */
+    void Execute() { result = vadProcessInterleaved(vad, rate, samples, format, frames, events); }
+
+    /**
+     *    Convert the per-channel events and pass them back to js
+     */
+    void HandleOKCallback()
+    {
+        HandleScope scope;
+        int channels = vadMultiChannels(vad);
+        Local<Array> array = New<Array>(channels);
+
+        for (int i = 0; i < channels; ++i)
+        {
+            Set(array, i, New(static_cast<int>(result ? VAD_EVENT_ERROR : events[i])));
+        }
+
+        Local<Value> argv[] = { Null(), array };
+        callback->Call(2, argv);    // callback(error, events)
+    }
+
+private:
+    vad_multi_t       vad;
+    int               rate;
+    const void*       samples;
+    vad_sample_format format;
+    size_t            frames;
+    int               result;
+    vad_event         events[VAD_MAX_CHANNELS];
+};
+
+// Async worker for per-frame voice activity detection of coalesced chunks
+class BatchVADWorker : public AsyncWorker
+{
+public:
+    struct Chunk
+    {
+        const float* samples;
+        size_t       length;    // number of samples
+    };
+
+    BatchVADWorker(Callback* callback, vad_t vad, int rate, const vector<Chunk>& chunks)
+        : AsyncWorker(callback), vad(vad), rate(rate), chunks(chunks) {}
+
+    ~BatchVADWorker() {}
+
+    /**
+     *    Performs work in a separate thread.
+     */
+    void Execute()
+    {
+        size_t capacity = 0;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            capacity += vadMaxFrames(rate, chunks[i].length);
+        }
+
+        events.resize(capacity);
+        counts.resize(chunks.size());
+
+        size_t total = 0;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            int count = vadProcessFrames(vad, rate, chunks[i].samples, chunks[i].length,
+                                         events.data() + total, capacity - total);
+            if (count < 0)
+            {
+                SetErrorMessage("Failed to process audio");
+                return;
+            }
+
+            counts[i] = count;
+            total += static_cast<size_t>(count);
+        }
+
+        events.resize(total);
+    }
+
+    /**
+     *    Convert the per-frame events and per-chunk frame counts and pass them back to js
+     */
+    void HandleOKCallback()
+    {
+        HandleScope scope;
+        Local<Object> buffer = Nan::NewBuffer(static_cast<uint32_t>(events.size())).ToLocalChecked();
+        int8_t* data = reinterpret_cast<int8_t*>(node::Buffer::Data(buffer));
+        Local<Array> array = New<Array>(static_cast<int>(counts.size()));
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            data[i] = static_cast<int8_t>(events[i]);
+        }
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            Set(array, static_cast<uint32_t>(i), New(counts[i]));
+        }
+
+        Local<Value> argv[] = { Null(), buffer, array };
+        callback->Call(3, argv);    // callback(error, events, counts)
+    }
+
+private:
+    vad_t             vad;
+    int               rate;
+    vector<Chunk>     chunks;
+    vector<vad_event> events;
+    vector<int>       counts;
+};
+
 }
 
 #if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 4 ||                      \
@@ -114,11 +238,12 @@ NAN_METHOD(vadAlloc_)
 
     Local<Object> obj = New<Object>();
 
-    // #0 buffer
+    // #0 buffer #1 [integer]
     void* mem         = node::Buffer::HasInstance(info[0]) ? node::Buffer::Data(info[0]) : NULL;
     size_t lenmem     = mem ? node::Buffer::Length(info[0]) : 0;
+    int rate          = info[1]->IsUint32() ? To<int32_t>(info[1]).FromJust() : 0;
 
-    vad_t vad = vadAllocate(mem, &lenmem);
+    vad_t vad = vadAllocateRate(mem, &lenmem, rate);
     Set(obj, New("size").ToLocalChecked(), New(static_cast<int>(lenmem)));
 
     if (mem)
@@ -178,6 +303,220 @@ NAN_METHOD(vadSetMode_)
     info.GetReturnValue().Set(result == 0);
 }
 
+// Wraps vadReset
+NAN_METHOD(vadReset_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    int result = vadReset(vad);
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Wraps vadSaveState
+NAN_METHOD(vadSave_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    size_t size = 0;
+    vadSaveState(vad, NULL, &size);
+
+    Local<Object> checkpoint = Nan::NewBuffer(static_cast<uint32_t>(size)).ToLocalChecked();
+    if (vadSaveState(vad, node::Buffer::Data(checkpoint), &size))
+    {
+        Nan::ThrowError("Failed to save VAD state");
+        return;
+    }
+
+    info.GetReturnValue().Set(checkpoint);
+}
+
+// Wraps vadLoadState
+NAN_METHOD(vadLoad_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 buffer
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad || !node::Buffer::HasInstance(info[1]))
+    {
+        if (!vad) Nan::ThrowTypeError("Invalid VAD instance!");
+        else Nan::ThrowTypeError("Invalid checkpoint buffer!");
+        return;
+    }
+
+    int result = vadLoadState(vad, node::Buffer::Data(info[1]), node::Buffer::Length(info[1]));
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Read pre-gate thresholds from arguments #1..#3; returns false to disable the gate
+static bool GetGateArgs(Nan::NAN_METHOD_ARGS_TYPE info, vad_gate_t* gate)
+{
+    if (info[1]->IsNull() || info[1]->IsUndefined())
+    {
+        return false;
+    }
+
+    gate->peak     = To<int32_t>(info[1]).FromMaybe(-1);
+    gate->energy   = To<int32_t>(info[2]).FromMaybe(-1);
+    gate->dc_range = To<int32_t>(info[3]).FromMaybe(-1);
+    return true;
+}
+
+// Create a pre-gate statistics object
+static Local<Object> GetGateStatsObject(size_t skipped, size_t frames)
+{
+    Local<Object> obj = New<Object>();
+    Set(obj, New("skipped").ToLocalChecked(), New(static_cast<double>(skipped)));
+    Set(obj, New("frames").ToLocalChecked(), New(static_cast<double>(frames)));
+    return obj;
+}
+
+// Wraps vadSetGate
+NAN_METHOD(vadSetGate_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 integer|null #2 integer #3 integer
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    vad_gate_t gate;
+    int result = vadSetGate(vad, GetGateArgs(info, &gate) ? &gate : NULL);
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Wraps vadGetGateStats
+NAN_METHOD(vadGateStats_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    size_t skipped = 0, frames = 0;
+    vadGetGateStats(vad, &skipped, &frames);
+
+    // return value is { skipped: Integer, frames: Integer }
+    info.GetReturnValue().Set(GetGateStatsObject(skipped, frames));
+}
+
+// Wraps vadPoolAllocate
+NAN_METHOD(vadPoolAlloc_)
+{
+    HandleScope scope;
+
+    Local<Object> obj = New<Object>();
+
+    // #0 buffer #1 integer #2 integer
+    void* mem         = node::Buffer::HasInstance(info[0]) ? node::Buffer::Data(info[0]) : NULL;
+    size_t lenmem     = mem ? node::Buffer::Length(info[0]) : 0;
+    uint32_t count    = To<uint32_t>(info[1]).FromJust();
+    int rate          = To<int32_t>(info[2]).FromJust();
+
+    vad_pool_t pool = vadPoolAllocate(mem, &lenmem, count, rate);
+    Set(obj, New("size").ToLocalChecked(), New(static_cast<double>(lenmem)));
+
+    if (mem)
+    {
+        bool error = pool != mem;
+        Set(obj, New("error").ToLocalChecked(), New(error));
+        if (!error)
+        {
+            Set(obj, New("slotSize").ToLocalChecked(), New(static_cast<double>(vadPoolSlotSize(pool))));
+        }
+    }
+    else
+    {
+        Set(obj, New("error").ToLocalChecked(), New(lenmem == 0));
+    }
+
+    // return value is { error: true|false, size: Integer[, slotSize: Integer] }
+    info.GetReturnValue().Set(obj);
+}
+
+// Wraps vadPoolAcquire
+NAN_METHOD(vadPoolAcquire_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_pool_t pool = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_pool_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!pool)
+    {
+        Nan::ThrowTypeError("Invalid VAD pool!");
+        return;
+    }
+
+    // return the offset of the slot within the pool buffer or -1 if exhausted
+    vad_t vad = vadPoolAcquire(pool);
+    double offset = vad ? static_cast<double>(reinterpret_cast<char*>(vad) - reinterpret_cast<char*>(pool)) : -1;
+    info.GetReturnValue().Set(offset);
+}
+
+// Wraps vadPoolRelease
+NAN_METHOD(vadPoolRelease_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 integer
+    vad_pool_t pool = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_pool_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!pool)
+    {
+        Nan::ThrowTypeError("Invalid VAD pool!");
+        return;
+    }
+
+    size_t offset = static_cast<size_t>(To<uint32_t>(info[1]).FromJust());
+    if (offset >= node::Buffer::Length(info[0]))
+    {
+        info.GetReturnValue().Set(false);
+        return;
+    }
+
+    vad_t vad = reinterpret_cast<vad_t>(node::Buffer::Data(info[0]) + offset);
+    int result = vadPoolRelease(pool, vad);
+    info.GetReturnValue().Set(result == 0);
+}
+
 // Wraps vadProcessAudio
 NAN_METHOD(vadProcessAudioBuffer_)
 {
@@ -204,6 +543,187 @@ NAN_METHOD(vadProcessAudioBuffer_)
     AsyncQueueWorker(worker);
 }
 
+// Wraps vadProcessFrames for a batch of chunks
+NAN_METHOD(vadProcessFrames_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 array of buffers #2 integer #3 callback
+    vad_t vad = node::Buffer::HasInstance(info[0]) ?
+                reinterpret_cast<vad_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad || !info[1]->IsArray())
+    {
+        if (!vad) Nan::ThrowTypeError("Invalid VAD instance!");
+        else Nan::ThrowTypeError("Invalid audio buffer!");
+        return;
+    }
+
+    Local<Array> buffers = info[1].As<Array>();
+    vector<BatchVADWorker::Chunk> chunks(buffers->Length());
+
+    for (uint32_t i = 0; i < buffers->Length(); ++i)
+    {
+        Local<Value> buffer = Get(buffers, i).ToLocalChecked();
+
+        if (!node::Buffer::HasInstance(buffer))
+        {
+            Nan::ThrowTypeError("Invalid audio buffer!");
+            return;
+        }
+
+        chunks[i].samples = reinterpret_cast<const float*>(node::Buffer::Data(buffer));
+        chunks[i].length = GetByteLength(buffer) / sizeof(float);
+    }
+
+    int rate = To<int32_t>(info[2]).FromJust();
+
+    Callback* callback = new Callback(info[3].As<Function>());
+    AsyncQueueWorker(new BatchVADWorker(callback, vad, rate, chunks));
+}
+
+// Wraps vadMultiAllocate
+NAN_METHOD(vadMultiAlloc_)
+{
+    HandleScope scope;
+
+    Local<Object> obj = New<Object>();
+
+    // #0 buffer #1 integer #2 [integer]
+    void* mem         = node::Buffer::HasInstance(info[0]) ? node::Buffer::Data(info[0]) : NULL;
+    size_t lenmem     = mem ? node::Buffer::Length(info[0]) : 0;
+    int channels      = To<int32_t>(info[1]).FromJust();
+    int rate          = info[2]->IsUint32() ? To<int32_t>(info[2]).FromJust() : 0;
+
+    vad_multi_t vad = vadMultiAllocate(mem, &lenmem, channels, rate);
+    Set(obj, New("size").ToLocalChecked(), New(static_cast<double>(lenmem)));
+
+    if (mem)
+    {
+        bool error = vad != mem;
+        Set(obj, New("error").ToLocalChecked(), New(error));
+    }
+    else
+    {
+        Set(obj, New("error").ToLocalChecked(), New(lenmem == 0));
+    }
+
+    // return value is { error: true|false, size: Integer }
+    info.GetReturnValue().Set(obj);
+}
+
+// Wraps vadMultiSetMode
+NAN_METHOD(vadMultiSetMode_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 integer
+    vad_multi_t vad = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_multi_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    vad_mode mode = static_cast<vad_mode>(To<int32_t>(info[1]).FromJust());
+
+    int result = vadMultiSetMode(vad, mode);
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Wraps vadMultiReset
+NAN_METHOD(vadMultiReset_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_multi_t vad = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_multi_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    int result = vadMultiReset(vad);
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Wraps vadMultiSetGate
+NAN_METHOD(vadMultiSetGate_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 integer|null #2 integer #3 integer
+    vad_multi_t vad = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_multi_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    vad_gate_t gate;
+    int result = vadMultiSetGate(vad, GetGateArgs(info, &gate) ? &gate : NULL);
+    info.GetReturnValue().Set(result == 0);
+}
+
+// Wraps vadMultiGetGateStats
+NAN_METHOD(vadMultiGateStats_)
+{
+    HandleScope scope;
+
+    // #0 buffer
+    vad_multi_t vad = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_multi_t>(node::Buffer::Data(info[0])) : NULL;
+
+    if (!vad)
+    {
+        Nan::ThrowTypeError("Invalid VAD instance!");
+        return;
+    }
+
+    size_t skipped = 0, frames = 0;
+    vadMultiGetGateStats(vad, &skipped, &frames);
+
+    // return value is { skipped: Integer, frames: Integer }
+    info.GetReturnValue().Set(GetGateStatsObject(skipped, frames));
+}
+
+// Wraps vadProcessInterleaved
+NAN_METHOD(vadProcessInterleaved_)
+{
+    HandleScope scope;
+
+    // #0 buffer #1 buffer #2 integer #3 integer #4 callback
+    vad_multi_t vad = node::Buffer::HasInstance(info[0]) ?
+                      reinterpret_cast<vad_multi_t>(node::Buffer::Data(info[0])) : NULL;
+    const void* samples = node::Buffer::HasInstance(info[1]) ?
+                      reinterpret_cast<const void*>(node::Buffer::Data(info[1])) : NULL;
+
+    if (!vad || !samples)
+    {
+        if (!vad) Nan::ThrowTypeError("Invalid VAD instance!");
+        else Nan::ThrowTypeError("Invalid audio buffer!");
+        return;
+    }
+
+    int rate = To<int32_t>(info[2]).FromJust();
+    vad_sample_format format = To<int32_t>(info[3]).FromJust() == VAD_SAMPLE_INT16 ?
+                               VAD_SAMPLE_INT16 : VAD_SAMPLE_FLOAT;
+
+    // whole sample frames only
+    size_t frameSize = vadMultiChannels(vad) * (format == VAD_SAMPLE_INT16 ? sizeof(short) : sizeof(float));
+    size_t frames = GetByteLength(info[1]) / frameSize;
+
+    Callback* callback = new Callback(info[4].As<Function>());
+    AsyncQueueWorker(new InterleavedVADWorker(callback, vad, rate, samples, format, frames));
+}
+
 // Setup the native exports
 NAN_MODULE_INIT(init)
 {
@@ -211,8 +731,27 @@ NAN_MODULE_INIT(init)
     Nan::Export(target, "vad_init", vadInit_);
     Nan::Export(target, "vad_setmode", vadSetMode_);
     Nan::Export(target, "vad_processAudio", vadProcessAudioBuffer_);
+    Nan::Export(target, "vad_processFrames", vadProcessFrames_);
+    Nan::Export(target, "vad_reset", vadReset_);
+    Nan::Export(target, "vad_save", vadSave_);
+    Nan::Export(target, "vad_load", vadLoad_);
+    Nan::Export(target, "vad_setgate", vadSetGate_);
+    Nan::Export(target, "vad_gate_stats", vadGateStats_);
+    Nan::Export(target, "vad_pool_alloc", vadPoolAlloc_);
+    Nan::Export(target, "vad_pool_acquire", vadPoolAcquire_);
+    Nan::Export(target, "vad_pool_release", vadPoolRelease_);
+    Nan::Export(target, "vad_multi_alloc", vadMultiAlloc_);
+    Nan::Export(target, "vad_multi_setmode", vadMultiSetMode_);
+    Nan::Export(target, "vad_multi_reset", vadMultiReset_);
+    Nan::Export(target, "vad_multi_setgate", vadMultiSetGate_);
+    Nan::Export(target, "vad_multi_gate_stats", vadMultiGateStats_);
+    Nan::Export(target, "vad_processInterleaved", vadProcessInterleaved_);
+    Nan::ForceSet(target, New("VAD_MAX_CHANNELS").ToLocalChecked(), New(VAD_MAX_CHANNELS),
+        static_cast<PropertyAttribute>(ReadOnly|DontDelete));
+    Nan::ForceSet(target, New("VAD_FRAME_DURATION").ToLocalChecked(), New(VAD_FRAME_DURATION),
+        static_cast<PropertyAttribute>(ReadOnly|DontDelete));
 }
 
 }
 
-NODE_MODULE(vad, vad::init)
+NAN_MODULE_WORKER_ENABLED(vad, vad::init)